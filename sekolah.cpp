@@ -7,6 +7,25 @@
 #include <limits>   // For std::numeric_limits
 #include <iomanip> // For std::setw and std::left
 #include <numeric>  // For std::accumulate
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem> // For listing the class/ folder
+#include <cstdint>
+#include <thread>   // For std::thread (statement reconciliation and cache warm-up workers)
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>  // For LockFileEx on the change log
+#else
+#include <cerrno>
+#include <fcntl.h>    // For open() and flock() on the change log
+#include <sys/file.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -39,6 +58,96 @@ struct TuitionRecord_t { // Renamed to avoid conflict with local struct in searc
     int unpaid_balance;      // The remaining balance after this transaction
 };
 
+// Compact Bloom filter over admitted NISNs, persisted next to the roster
+struct NisnBloomFilter_t {
+    vector<uint64_t> bits;
+    uint32_t num_bits = 0;
+    uint32_t num_hashes = 0;
+    uint32_t entry_count = 0;
+    uint64_t roster_size = 0; // Size of the roster file the filter was built for, used to detect a stale filter
+};
+
+// Struct for one conduct note in the inverted index (conduct_index.txt)
+struct ConductIndexEntry_t {
+    int nisn;
+    string name;
+    int note_offset; // Position of the note in the student's conduct_log
+    string date;
+    string type;
+};
+
+// Struct for one cached student detail file, stamped so edits by other processes are noticed
+struct StudentCacheEntry_t {
+    student record;
+    filesystem::file_time_type mtime;
+    uintmax_t size;
+};
+
+// Struct for one column of a columnar export table.
+// Ints/floats go to <table>.<column>.i32/.f32. Low-cardinality strings are dictionary-encoded into
+// <table>.<column>.u32 codes plus .dict.off (uint64 offsets) and .dict.bin (bytes); free text, and any
+// dictionary column that outgrows EXPORT_DICT_MAX_ENTRIES, is written plain as .off (uint64 end offset
+// per row after a leading 0) and .bin (bytes) from first_plain_row on.
+struct ExportColumn_t {
+    string name;
+    char type;                    // 'i' int32, 'f' float32, 's' dictionary string, 'p' plain string
+    string base_path;             // <folder><table>.<column>
+    ofstream data_out;            // .i32/.f32 values or .u32 dictionary codes
+    vector<char> group_buffer;    // Fixed-width values of the current row group
+    vector<string> group_strings; // String values of the current row group, encoded when the group is flushed
+    unordered_map<string, uint32_t> dictionary;
+    ofstream dict_offsets_out, dict_bytes_out;
+    uint64_t dict_bytes_written = 0;
+    bool plain = false;           // Always for 'p'; set for 's' once the dictionary would overflow
+    size_t first_plain_row = 0;
+    ofstream plain_offsets_out, plain_bytes_out;
+    uint64_t plain_bytes_written = 0;
+};
+
+// Struct for one table of a columnar export
+struct ExportTable_t {
+    string name;
+    vector<ExportColumn_t> columns;
+    size_t row_count = 0;
+    size_t rows_in_group = 0;
+    size_t row_group_count = 0;
+    ofstream csv_out;          // Only open when the CSV fallback was requested
+    string csv_row;
+};
+
+// Struct for the in-memory copy of the data kept by a read-only replica
+struct ReplicaState_t {
+    map<int, student> students;                       // Admitted students with grades and conduct logs
+    unordered_map<int, TuitionRecord_t> latest_tuition; // Latest ledger line per NISN
+    streamoff log_offset = 0;        // Bytes of the change log already applied
+    long long applied_seq = 0;       // Sequence number of the last applied change
+    long long applied_primary_ms = 0; // When the primary recorded the last applied change
+    long long applied_local_ms = 0;  // When the replica applied it
+    long long last_poll_ms = 0;      // When the replica last read the change log
+    long long pending_bytes = 0;     // Change log bytes written by the sessions but not applied yet
+};
+
+// Scoped exclusive lock on the change log shared by every session, see lockChangeLog()
+struct ChangeLogLock_t {
+    ChangeLogLock_t();
+    ~ChangeLogLock_t();
+};
+
+// Struct for one row of an imported bank statement
+struct StatementRow_t {
+    size_t row_no;   // Line number in the statement file
+    int nisn;
+    int amount;
+    string raw_line;
+};
+
+// Struct for the outcome of applying one statement row against the ledger
+struct ReconcileResult_t {
+    bool applied;
+    TuitionRecord_t record;   // Ledger line to append, valid when applied
+    string exception_reason;  // Why the row went to the exceptions report, valid when not applied
+};
+
 
 student newstudent_arr[MAX_STUDENTS];
 int count_new_students = 0;
@@ -47,27 +156,124 @@ int admission_capacity = 2;
 string main_student_data_file = "data_student.txt";
 string student_details_folder = "class/";
 string tuition_file = "tuition.txt";
+string tuition_exceptions_file = "tuition_exceptions.txt";
+string nisn_bloom_file = "data_student.bloom";
+
+NisnBloomFilter_t nisn_bloom;
+bool nisn_bloom_ready = false;
+string conduct_index_file = "conduct_index.txt";
+
+string change_log_file = "changes.log";
+string replica_snapshot_folder = "replica_snapshot/";
+int change_log_lock_depth = 0; // Nested ChangeLogLock_t scopes in this process
+#ifdef _WIN32
+HANDLE change_log_lock_handle = INVALID_HANDLE_VALUE;
+#else
+int change_log_lock_fd = -1;
+#endif
+const int REPLICA_POLL_INTERVAL_MS = 200;
+
+string export_default_folder = "export/";
+const size_t EXPORT_ROW_GROUP_SIZE = 4096; // Rows buffered per column before writing, keeps memory flat
+const size_t EXPORT_DICT_MAX_ENTRIES = 4096; // Larger dictionaries fall back to plain encoding
+
+const size_t STUDENT_CACHE_CAPACITY = 256; // Max student detail records kept in memory
+list<pair<string, StudentCacheEntry_t>> student_cache_lru; // Keyed by file path, front = most recently used
+unordered_map<string, list<pair<string, StudentCacheEntry_t>>::iterator> student_cache_lookup;
+mutex student_cache_mutex;
+
+vector<ConductIndexEntry_t> conduct_index_entries;
+map<string, vector<size_t>> conduct_index_by_date;           // Sorted date buckets -> entry positions
+unordered_map<string, vector<size_t>> conduct_index_by_type; // Lower-cased note type -> entry positions
+bool conduct_index_loaded = false;
+uintmax_t conduct_index_loaded_size = 0; // Bytes of conduct_index.txt already in the buckets
+string conduct_index_last_line;          // Raw last line read, to notice another session rewriting the file
+
+unordered_set<int> admitted_nisn_set; // Exact index, only loaded when the Bloom filter reports a possible hit
+bool admitted_nisn_set_loaded = false;
 
 
 // --- Function Declarations ---
+void loadAdmittedNisnSet();
+void buildNisnBloomFilter();
+void ensureNisnBloomFilter();
+uint64_t rosterSizeOnDisk();
+void refreshNisnBloomFilterIfStale(uint64_t roster_size);
+bool saveNisnBloomFilter();
+bool loadNisnBloomFilter();
+void bloomAddNisn(NisnBloomFilter_t& bloom, int nisn);
+bool bloomMayContainNisn(const NisnBloomFilter_t& bloom, int nisn);
+bool isNisnAlreadyAdmitted(int nisn);
+void recordAdmittedNisn(int nisn);
 void registration();
 void showRegistrationResult();
 void inputGradesLoader(int mode);
 void inputGradesRecursive(const vector<StudentSimple>& students, int num_students);
 void displayAndCalculateAverage(const StudentSimple& selected_student, const string& student_details_folder);
+bool parseTuitionLine(int file_id, const string& line_content, TuitionRecord_t& out_record);
 bool getLatestTuitionRecordForPayment(int nisn_to_search, string& out_student_name, int& out_outstanding_balance); // New Helper
+void loadLatestTuitionRecords(unordered_map<int, TuitionRecord_t>& out_latest);
+void reconcileStatementPartition(const vector<StatementRow_t>& rows, const vector<size_t>& row_indices,
+                                 const unordered_map<int, TuitionRecord_t>& latest_records,
+                                 const unordered_map<int, string>& roster_names,
+                                 vector<ReconcileResult_t>& results);
+void importBankStatement();
 void payTuition();
 void searchTuitionStatus();
 void menuTuition();
 void displayStudentDetailsWithPointer(const student* s);
 void clearInputBuffer();
+void trimCarriageReturn(string& line);
 bool isValidNisn(const string& nisn_str, int& nisn_int);
 bool isValidGrade(const string& grade_str, float& grade_float);
+bool isValidAmount(const string& amount_str, int& amount_int);
+bool isValidCount(const string& count_str, int& count_int);
 void menuConductLog();
 void addConductNote();
 void viewConductNotes();
-void loadStudentDetailForConduct(student& s_detail, const string& nisn, const string& name);
+bool statStudentFile(const string& path, filesystem::file_time_type& out_mtime, uintmax_t& out_size);
+bool studentCacheGet(const string& path, student& out_record);
+void studentCachePut(const string& path, const student& record, filesystem::file_time_type mtime, uintmax_t size);
+void studentCacheInvalidate(const string& path);
+uintmax_t textBytesOnDisk(const string& text);
+void studentCacheRefresh(const string& path, const student& record, uintmax_t expected_size);
+void warmStudentCache();
+void parseStudentDetail(istream& in, student& s_detail);
+bool loadStudentDetailForConduct(student& s_detail, const string& nisn, const string& name);
 void saveStudentDetailWithConduct(const student& s_detail);
+bool openExportTable(ExportTable_t& table, const string& folder, const string& table_name,
+                     const vector<pair<string, char>>& column_defs, bool with_csv);
+void exportPutInt(ExportTable_t& table, size_t col, int value);
+void exportPutFloat(ExportTable_t& table, size_t col, float value);
+void exportPutString(ExportTable_t& table, size_t col, const string& value);
+void exportEndRow(ExportTable_t& table);
+void closeExportTable(ExportTable_t& table, ofstream& manifest_out);
+void exportSchoolData();
+long long nowMillis();
+void lockChangeLog();
+void unlockChangeLog();
+long long readLastChangeSeq(bool& out_ends_with_newline);
+void recordChanges(const string& op, const vector<vector<string>>& rows);
+void recordChange(const string& op, const vector<string>& fields);
+bool copySnapshotEntry(const string& source, const string& dest_folder);
+bool startPrimaryReplication();
+string readSnapshotMarker(const string& snapshot_folder);
+bool loadReplicaSnapshot(ReplicaState_t& state, const string& snapshot_folder);
+bool applyChangeLine(ReplicaState_t& state, const string& line);
+void pollChangeLog(ReplicaState_t& state);
+void replicaShowGrades(ReplicaState_t& state);
+void replicaGradeReport(ReplicaState_t& state);
+void replicaSearchTuition(ReplicaState_t& state);
+void replicaShowStatus(ReplicaState_t& state);
+int runReplica(const string& snapshot_folder);
+bool parseConductLogLine(const string& log_line, string& out_date, string& out_type, string& out_note);
+void addConductIndexEntry(const ConductIndexEntry_t& entry);
+bool appendConductIndexEntry(const ConductIndexEntry_t& entry);
+void rebuildConductIndex();
+void ensureConductIndex();
+vector<size_t> queryConductIndex(const string& type_filter, const string& date_from, const string& date_to);
+void searchConductNotes();
+void reportRepeatConductNotes();
 
 // --- Function Implementations ---
 
@@ -75,6 +281,11 @@ void clearInputBuffer() {
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
+// Data files are written on Windows; drop the '\r' left behind when reading them elsewhere
+void trimCarriageReturn(string& line) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+}
+
 bool isValidNisn(const string& nisn_str, int& nisn_int) {
     if (nisn_str.empty()) return false;
     for (char const &c : nisn_str) {
@@ -87,6 +298,16 @@ bool isValidNisn(const string& nisn_str, int& nisn_int) {
     } catch (const std::invalid_argument&) { return false; }
 }
 
+// Plain non-negative integer, e.g. a position in a list
+bool isValidCount(const string& count_str, int& count_int) {
+    if (count_str.empty() || count_str.size() > 9) return false;
+    for (char const &c : count_str) {
+        if (std::isdigit(static_cast<unsigned char>(c)) == 0) return false;
+    }
+    count_int = stoi(count_str);
+    return true;
+}
+
 bool isValidGrade(const string& grade_str, float& grade_float) {
     if (grade_str.empty()) return false;
     size_t dot_count = 0;
@@ -102,6 +323,41 @@ bool isValidGrade(const string& grade_str, float& grade_float) {
     } catch (const std::invalid_argument&) { return false; }
 }
 
+// Bank statement amount: plain digits or digits grouped by '.' or ',' (1.000.000, 1,000,000),
+// optionally followed by a zero-valued decimal part (1000000.00, 1.000.000,00)
+bool isValidAmount(const string& amount_str, int& amount_int) {
+    string digits = amount_str;
+    size_t last_sep = digits.find_last_of(".,");
+    if (last_sep != string::npos) {
+        size_t frac_len = digits.length() - last_sep - 1;
+        if (frac_len == 1 || frac_len == 2) { // Decimal part, must be whole rupiah
+            string frac = digits.substr(last_sep + 1);
+            if (frac.find_first_not_of('0') != string::npos) return false;
+            digits = digits.substr(0, last_sep);
+        }
+    }
+    size_t sep_pos = digits.find_first_of(".,");
+    if (sep_pos != string::npos) {
+        char sep = digits[sep_pos];
+        if (sep_pos == 0 || sep_pos > 3) return false; // First group has 1-3 digits
+        if ((digits.length() - sep_pos) % 4 != 0) return false; // Every later group is <sep><3 digits>
+        string plain = digits.substr(0, sep_pos);
+        for (size_t pos = sep_pos; pos < digits.length(); pos += 4) {
+            if (digits[pos] != sep) return false;
+            plain += digits.substr(pos + 1, 3);
+        }
+        digits = plain;
+    }
+    if (digits.empty() || digits.length() > 10) return false;
+    for (char const &c : digits) {
+        if (std::isdigit(static_cast<unsigned char>(c)) == 0) return false;
+    }
+    long long value = stoll(digits);
+    if (value > numeric_limits<int>::max()) return false;
+    amount_int = static_cast<int>(value);
+    return true;
+}
+
 void displayStudentDetailsWithPointer(const student* s) {
     if (s == nullptr) { cout << "Error: Null student pointer." << endl; return; }
     cout << "  Name (via ptr): " << s->name << endl;
@@ -110,6 +366,144 @@ void displayStudentDetailsWithPointer(const student* s) {
     cout << "---------------------------" << endl;
 }
 
+// --- Duplicate NISN detection ---
+
+// Exact set of admitted NISNs from data_student.txt and the class/ file names (<NISN>_<Name>.txt)
+void loadAdmittedNisnSet() {
+    admitted_nisn_set.clear();
+    ifstream ifs_roster(main_student_data_file);
+    if (ifs_roster.is_open()) {
+        string ni, n;
+        int ni_int;
+        while (getline(ifs_roster, ni) && getline(ifs_roster, n)) {
+            trimCarriageReturn(ni);
+            if (isValidNisn(ni, ni_int)) admitted_nisn_set.insert(ni_int);
+        }
+        ifs_roster.close();
+    }
+    error_code ec;
+    for (const auto& entry : filesystem::directory_iterator(student_details_folder, ec)) {
+        string file_name = entry.path().filename().string();
+        size_t underscore_pos = file_name.find('_');
+        int ni_int;
+        if (underscore_pos != string::npos && isValidNisn(file_name.substr(0, underscore_pos), ni_int)) {
+            admitted_nisn_set.insert(ni_int);
+        }
+    }
+    admitted_nisn_set_loaded = true;
+}
+
+static uint64_t mixNisnHash(uint64_t x) { // splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void bloomAddNisn(NisnBloomFilter_t& bloom, int nisn) {
+    uint64_t h = mixNisnHash(static_cast<uint32_t>(nisn));
+    uint64_t h1 = h & 0xffffffffULL, h2 = (h >> 32) | 1;
+    for (uint32_t i = 0; i < bloom.num_hashes; i++) {
+        uint64_t bit = (h1 + i * h2) % bloom.num_bits;
+        bloom.bits[bit / 64] |= (1ULL << (bit % 64));
+    }
+    bloom.entry_count++;
+}
+
+bool bloomMayContainNisn(const NisnBloomFilter_t& bloom, int nisn) {
+    uint64_t h = mixNisnHash(static_cast<uint32_t>(nisn));
+    uint64_t h1 = h & 0xffffffffULL, h2 = (h >> 32) | 1;
+    for (uint32_t i = 0; i < bloom.num_hashes; i++) {
+        uint64_t bit = (h1 + i * h2) % bloom.num_bits;
+        if ((bloom.bits[bit / 64] & (1ULL << (bit % 64))) == 0) return false;
+    }
+    return true;
+}
+
+// Rebuilds the filter from the exact set, sized for ~1% false positives with room to grow
+void buildNisnBloomFilter() {
+    nisn_bloom.roster_size = rosterSizeOnDisk(); // Taken before reading, so a concurrent append shows up as stale later
+    loadAdmittedNisnSet();
+    uint32_t capacity = max<uint32_t>(1024, static_cast<uint32_t>(admitted_nisn_set.size()) * 2);
+    nisn_bloom.num_bits = capacity * 10;
+    nisn_bloom.num_hashes = 7;
+    nisn_bloom.entry_count = 0;
+    nisn_bloom.bits.assign((nisn_bloom.num_bits + 63) / 64, 0);
+    for (int nisn : admitted_nisn_set) bloomAddNisn(nisn_bloom, nisn);
+    nisn_bloom_ready = true;
+    saveNisnBloomFilter();
+}
+
+// Persists the filter with the roster size it was built for, never the current size on disk
+bool saveNisnBloomFilter() {
+    ofstream ofs_bloom(nisn_bloom_file, ios::out | ios::binary);
+    if (!ofs_bloom.is_open()) { cout << "Error: Failed to open " << nisn_bloom_file << " for writing!" << endl; return false; }
+    ofs_bloom.write("NBF1", 4);
+    ofs_bloom.write(reinterpret_cast<const char*>(&nisn_bloom.num_bits), sizeof(nisn_bloom.num_bits));
+    ofs_bloom.write(reinterpret_cast<const char*>(&nisn_bloom.num_hashes), sizeof(nisn_bloom.num_hashes));
+    ofs_bloom.write(reinterpret_cast<const char*>(&nisn_bloom.entry_count), sizeof(nisn_bloom.entry_count));
+    ofs_bloom.write(reinterpret_cast<const char*>(&nisn_bloom.roster_size), sizeof(nisn_bloom.roster_size));
+    ofs_bloom.write(reinterpret_cast<const char*>(nisn_bloom.bits.data()), nisn_bloom.bits.size() * sizeof(uint64_t));
+    ofs_bloom.close();
+    return true;
+}
+
+// Returns false when the file is missing, corrupt or was built for a different roster
+bool loadNisnBloomFilter() {
+    ifstream ifs_bloom(nisn_bloom_file, ios::in | ios::binary);
+    if (!ifs_bloom.is_open()) return false;
+    char magic[4];
+    NisnBloomFilter_t loaded;
+    ifs_bloom.read(magic, 4);
+    ifs_bloom.read(reinterpret_cast<char*>(&loaded.num_bits), sizeof(loaded.num_bits));
+    ifs_bloom.read(reinterpret_cast<char*>(&loaded.num_hashes), sizeof(loaded.num_hashes));
+    ifs_bloom.read(reinterpret_cast<char*>(&loaded.entry_count), sizeof(loaded.entry_count));
+    ifs_bloom.read(reinterpret_cast<char*>(&loaded.roster_size), sizeof(loaded.roster_size));
+    if (!ifs_bloom || string(magic, 4) != "NBF1" || loaded.num_bits == 0 || loaded.num_hashes == 0) return false;
+    loaded.bits.resize((loaded.num_bits + 63) / 64);
+    ifs_bloom.read(reinterpret_cast<char*>(loaded.bits.data()), loaded.bits.size() * sizeof(uint64_t));
+    if (!ifs_bloom) return false;
+    ifs_bloom.close();
+
+    if (rosterSizeOnDisk() != loaded.roster_size) return false; // Roster changed outside this program
+    nisn_bloom = loaded;
+    nisn_bloom_ready = true;
+    return true;
+}
+
+void ensureNisnBloomFilter() {
+    if (nisn_bloom_ready) return;
+    if (!loadNisnBloomFilter()) buildNisnBloomFilter();
+}
+
+uint64_t rosterSizeOnDisk() {
+    error_code ec;
+    uintmax_t roster_size = filesystem::file_size(main_student_data_file, ec);
+    return ec ? 0 : roster_size;
+}
+
+// Rebuilds when other operators appended to the roster since this filter was built
+void refreshNisnBloomFilterIfStale(uint64_t roster_size) {
+    ensureNisnBloomFilter();
+    if (nisn_bloom.roster_size != roster_size) buildNisnBloomFilter();
+}
+
+// Bloom filter answers "definitely new" without touching the roster; possible hits are confirmed exactly
+bool isNisnAlreadyAdmitted(int nisn) {
+    refreshNisnBloomFilterIfStale(rosterSizeOnDisk());
+    if (!bloomMayContainNisn(nisn_bloom, nisn)) return false;
+    if (!admitted_nisn_set_loaded) loadAdmittedNisnSet();
+    return admitted_nisn_set.count(nisn) > 0;
+}
+
+// Call after the roster has been appended; the caller stamps the new roster size
+void recordAdmittedNisn(int nisn) {
+    ensureNisnBloomFilter();
+    if (admitted_nisn_set_loaded) admitted_nisn_set.insert(nisn);
+    if (nisn_bloom.entry_count * 10 >= nisn_bloom.num_bits) { buildNisnBloomFilter(); return; } // Over capacity, resize
+    bloomAddNisn(nisn_bloom, nisn);
+}
+
 void registration() {
     int num_to_register;
     cout << "How many students will register? : ";
@@ -125,8 +519,16 @@ void registration() {
         cout << "Name of student: "; getline(cin, newstudent_arr[count_new_students].name);
         string nisn_str;
         cout << "NISN of student: ";
-        while (getline(cin, nisn_str) && !isValidNisn(nisn_str, newstudent_arr[count_new_students].NISN)) {
-            cout << "Invalid NISN. Please enter a numeric NISN: ";
+        while (getline(cin, nisn_str)) {
+            int& entered_nisn = newstudent_arr[count_new_students].NISN;
+            if (!isValidNisn(nisn_str, entered_nisn)) { cout << "Invalid NISN. Please enter a numeric NISN: "; continue; }
+            bool in_batch = false;
+            for (int j = 0; j < count_new_students; j++) {
+                if (newstudent_arr[j].NISN == entered_nisn) { in_batch = true; break; }
+            }
+            if (in_batch) { cout << "NISN " << entered_nisn << " was already entered in this batch. Please enter another NISN: "; continue; }
+            if (isNisnAlreadyAdmitted(entered_nisn)) { cout << "NISN " << entered_nisn << " is already admitted. Please enter another NISN: "; continue; }
+            break;
         }
         cout << "Place of birth of student: "; getline(cin, newstudent_arr[count_new_students].placeofbirth);
         cout << "Date of birth of student (DD/MM/YYYY): "; getline(cin, newstudent_arr[count_new_students].dateofbirth);
@@ -177,17 +579,52 @@ void showRegistrationResult() {
         cout << "\nDo you want to save these " << admitted_count << " admitted students' data? (y/n): ";
         cin >> decision; clearInputBuffer();
         if (decision == "y" || decision == "Y") {
+            // Flag conflicts inside the batch and against the admitted roster before anything is appended
+            vector<int> to_save;
+            for (int i = 0; i < admitted_count; i++) {
+                bool conflict = false;
+                for (int j : to_save) {
+                    if (newstudent_arr[j].NISN == newstudent_arr[i].NISN) { conflict = true; break; }
+                }
+                if (conflict) { cout << "Conflict: NISN " << newstudent_arr[i].NISN << " (" << newstudent_arr[i].name << ") appears twice in this batch. Skipped." << endl; continue; }
+                if (isNisnAlreadyAdmitted(newstudent_arr[i].NISN)) { cout << "Conflict: NISN " << newstudent_arr[i].NISN << " (" << newstudent_arr[i].name << ") is already admitted. Skipped." << endl; continue; }
+                to_save.push_back(i);
+            }
+            if (to_save.empty()) { cout << "No new students to save." << endl; return; }
+
+            ChangeLogLock_t change_log_lock; // Held through the detail files, so a snapshot has the whole batch or none of it
+            uint64_t roster_size_before = rosterSizeOnDisk();
+            refreshNisnBloomFilterIfStale(roster_size_before);
+            stringstream roster_batch;
+            for (int i : to_save) {
+                roster_batch << newstudent_arr[i].NISN << "\n" << newstudent_arr[i].name << "\n";
+            }
+            string roster_lines = roster_batch.str();
+            uint64_t appended_bytes = roster_lines.size();
+#ifdef _WIN32
+            appended_bytes += count(roster_lines.begin(), roster_lines.end(), '\n'); // Text mode writes "\r\n"
+#endif
             ofstream ofs_local_main_data;
             ofs_local_main_data.open(main_student_data_file, ios::app);
             if (!ofs_local_main_data.is_open()) { cout << "Error: Failed to open " << main_student_data_file << "!" << endl; }
             else {
-                for (int i = 0; i < admitted_count; i++) {
-                    ofs_local_main_data << newstudent_arr[i].NISN << endl; ofs_local_main_data << newstudent_arr[i].name << endl;
-                }
+                ofs_local_main_data << roster_lines;
                 ofs_local_main_data.close();
+                for (int i : to_save) recordAdmittedNisn(newstudent_arr[i].NISN);
+                // Only claim the new size if the growth is exactly our own lines; otherwise leave it stale so the next check rebuilds
+                uint64_t roster_size_after = rosterSizeOnDisk();
+                nisn_bloom.roster_size = (roster_size_after == roster_size_before + appended_bytes) ? roster_size_after : 0;
+                saveNisnBloomFilter();
+                vector<vector<string>> admitted_changes;
+                for (int i : to_save) {
+                    stringstream grade_ss; grade_ss << newstudent_arr[i].grade;
+                    admitted_changes.push_back({to_string(newstudent_arr[i].NISN), newstudent_arr[i].name, newstudent_arr[i].placeofbirth,
+                                                newstudent_arr[i].dateofbirth, newstudent_arr[i].gender, grade_ss.str()});
+                }
+                recordChanges("ADMIT", admitted_changes);
             }
             ofstream ofs_local_student_detail;
-            for (int i = 0; i < admitted_count; i++) {
+            for (int i : to_save) {
                 string student_file_path = student_details_folder + to_string(newstudent_arr[i].NISN) + "_" + newstudent_arr[i].name + ".txt";
                 ofs_local_student_detail.open(student_file_path, ios::out);
                 if (!ofs_local_student_detail.is_open()) { cout << "Error: Failed to open file " << student_file_path << endl; continue; }
@@ -214,6 +651,7 @@ void inputGradesLoader(int mode) {
     }
     string line1, line2;
     while (getline(ifs_loader, line1) && getline(ifs_loader, line2)) {
+        trimCarriageReturn(line1); trimCarriageReturn(line2);
         current_accepted_students.push_back({line2, line1}); 
     }
     ifs_loader.close();
@@ -275,6 +713,14 @@ void inputGradesRecursive(const vector<StudentSimple>& students_list, int num_st
     StudentSimple selected_student_recursive = students_list[choice_recursive - 1];
     string student_file_path = student_details_folder + selected_student_recursive.NISN + "_" + selected_student_recursive.name + ".txt";
     
+    // The cached record is kept in step with the appended lines below only while nobody else writes the file:
+    // each append must start from the stamp we expect and grow the file by exactly our own line
+    student cached_record;
+    filesystem::file_time_type expected_mtime;
+    uintmax_t expected_size = 0;
+    bool record_cached = statStudentFile(student_file_path, expected_mtime, expected_size) &&
+                         studentCacheGet(student_file_path, cached_record);
+
     ofstream ofs_local_grades;
     ofs_local_grades.open(student_file_path, ios::app);
     if (!ofs_local_grades.is_open()) {
@@ -294,12 +740,30 @@ void inputGradesRecursive(const vector<StudentSimple>& students_list, int num_st
             cin.clear(); clearInputBuffer();
         }
         clearInputBuffer();
-        ofs_local_grades << "Subject: " << subject_name << ", Grade: " << subject_grade_val << endl;
+        string grade_line = "Subject: " + subject_name + ", Grade: " + to_string(subject_grade_val) + "\n";
+        {
+            ChangeLogLock_t change_log_lock; // Held until the grade is logged, so a snapshot has both or neither
+            filesystem::file_time_type mtime_before;
+            uintmax_t size_before;
+            if (record_cached && (!statStudentFile(student_file_path, mtime_before, size_before) ||
+                                  mtime_before != expected_mtime || size_before != expected_size)) {
+                record_cached = false; // Another session wrote the file while the operator was typing
+            }
+            ofs_local_grades << grade_line << flush;
+            if (record_cached) {
+                cached_record.subject_grades.push_back({subject_name, subject_grade_val});
+                record_cached = statStudentFile(student_file_path, expected_mtime, expected_size) &&
+                                expected_size == size_before + textBytesOnDisk(grade_line);
+            }
+            recordChange("GRADE", {selected_student_recursive.NISN, selected_student_recursive.name, subject_name, to_string(subject_grade_val)});
+        }
         cout << "Grade for " << subject_name << " added." << endl;
         cout << "Add more subjects for THIS student? (y/n): ";
         cin >> add_more_subjects; clearInputBuffer(); cout << endl;
     } while (add_more_subjects == "y" || add_more_subjects == "Y");
     ofs_local_grades.close();
+    if (record_cached) studentCachePut(student_file_path, cached_record, expected_mtime, expected_size);
+    else studentCacheInvalidate(student_file_path);
     cout << "Grades updated for " << selected_student_recursive.name << "." << endl;
 
     string input_for_another_student;
@@ -316,50 +780,26 @@ void displayAndCalculateAverage(const StudentSimple& selected_student, const str
     cout << "\n--- Show Grades and Average for " << selected_student.name << " ---" << endl;
     string student_file_path = student_details_folder + selected_student.NISN + "_" + selected_student.name + ".txt";
 
-    ifstream ifs_avg(student_file_path);
-    if (!ifs_avg.is_open()) {
+    student s_detail;
+    if (!loadStudentDetailForConduct(s_detail, selected_student.NISN, selected_student.name)) { // Served from the record cache when warm
         cout << "Error: Failed to open file: " << student_file_path << endl;
         return;
     }
 
-    string line;
     vector<int> grades_vec; 
-    bool grades_found_flag = false; 
-
     cout << "Grades for " << selected_student.name << ":" << endl;
-    while (getline(ifs_avg, line)) {
-        size_t subject_pos = line.find("Subject: ");
-        size_t grade_pos = line.find(", Grade: ");
-
-        if (subject_pos != string::npos && grade_pos != string::npos && grade_pos > subject_pos) { 
-            grades_found_flag = true;
-            string subject_name = line.substr(subject_pos + string("Subject: ").length(),
-                                              grade_pos - (subject_pos + string("Subject: ").length()));
-            string grade_str_val = line.substr(grade_pos + string(", Grade: ").length()); 
-            try {
-                int grade_val_int = stoi(grade_str_val); 
-                grades_vec.push_back(grade_val_int);
-                cout << "- " << subject_name << ": " << grade_val_int << endl;
-            } catch (const invalid_argument& e) {
-                cerr << "Warning: Could not parse grade from line: " << line << " (Error: " << e.what() << ")" << endl;
-            } catch (const out_of_range& e) {
-                cerr << "Warning: Grade out of range in line: " << line << " (Error: " << e.what() << ")" << endl;
-            }
-        }
+    for (const auto& sg : s_detail.subject_grades) {
+        grades_vec.push_back(sg.second);
+        cout << "- " << sg.first << ": " << sg.second << endl;
     }
-    ifs_avg.close();
 
-    if (!grades_found_flag) {
+    if (grades_vec.empty()) {
         cout << "No grades found for " << selected_student.name << "." << endl;
     } else {
-        if (!grades_vec.empty()) {
-            double sum_of_grades = accumulate(grades_vec.begin(), grades_vec.end(), 0.0);
-            double average_grade_val = sum_of_grades / grades_vec.size(); 
-            cout << fixed << setprecision(2);
-            cout << "\nAverage grade for " << selected_student.name << ": " << average_grade_val << endl;
-        } else {
-            cout << "Cannot calculate average. No valid grades were parsed." << endl;
-        }
+        double sum_of_grades = accumulate(grades_vec.begin(), grades_vec.end(), 0.0);
+        double average_grade_val = sum_of_grades / grades_vec.size(); 
+        cout << fixed << setprecision(2);
+        cout << "\nAverage grade for " << selected_student.name << ": " << average_grade_val << endl;
     }
 }
 
@@ -371,7 +811,10 @@ void menuConductLog() {
         cout << "+==============================+" << endl;
         cout << "1. Add Conduct Note" << endl;
         cout << "2. View Conduct Notes for Student" << endl;
-        cout << "3. Back to Main Menu" << endl;
+        cout << "3. Search Notes by Type and Date (All Students)" << endl;
+        cout << "4. Students with Repeated Notes of a Type" << endl;
+        cout << "5. Rebuild Conduct Index" << endl;
+        cout << "6. Back to Main Menu" << endl;
         cout << "Choose: ";
         while (!(cin >> choice)) {
             cout << "Invalid input. Please enter a number: "; cin.clear(); clearInputBuffer();
@@ -380,14 +823,156 @@ void menuConductLog() {
         switch (choice) {
             case 1: addConductNote(); break;
             case 2: viewConductNotes(); break;
-            case 3: cout << "Returning to Main Menu..." << endl; break;
+            case 3: searchConductNotes(); break;
+            case 4: reportRepeatConductNotes(); break;
+            case 5: rebuildConductIndex(); cout << "Conduct index rebuilt: " << conduct_index_entries.size() << " note(s) indexed." << endl; break;
+            case 6: cout << "Returning to Main Menu..." << endl; break;
             default: cout << "Invalid choice. Please try again!" << endl;
         }
-        if (choice !=3) { cout << "Press Enter to continue..."; cin.get(); }
-    } while (choice != 3);
+        if (choice !=6) { cout << "Press Enter to continue..."; cin.get(); }
+    } while (choice != 6);
 }
 
-void loadStudentDetailForConduct(student& s_detail, const string& nisn_str_param, const string& name_param) {
+// --- Student record cache ---
+
+bool statStudentFile(const string& path, filesystem::file_time_type& out_mtime, uintmax_t& out_size) {
+    error_code ec;
+    out_mtime = filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    out_size = filesystem::file_size(path, ec);
+    return !ec;
+}
+
+// Returns false on a miss or when the file changed on disk since it was cached
+bool studentCacheGet(const string& path, student& out_record) {
+    filesystem::file_time_type mtime;
+    uintmax_t size;
+    bool on_disk = statStudentFile(path, mtime, size);
+    lock_guard<mutex> lock(student_cache_mutex);
+    auto it = student_cache_lookup.find(path);
+    if (it == student_cache_lookup.end()) return false;
+    if (!on_disk || it->second->second.mtime != mtime || it->second->second.size != size) {
+        student_cache_lru.erase(it->second);
+        student_cache_lookup.erase(it);
+        return false;
+    }
+    student_cache_lru.splice(student_cache_lru.begin(), student_cache_lru, it->second);
+    out_record = it->second->second.record;
+    return true;
+}
+
+// mtime/size must be taken before the file was read, so a concurrent edit makes the entry look stale
+void studentCachePut(const string& path, const student& record, filesystem::file_time_type mtime, uintmax_t size) {
+    lock_guard<mutex> lock(student_cache_mutex);
+    auto it = student_cache_lookup.find(path);
+    if (it != student_cache_lookup.end()) {
+        student_cache_lru.erase(it->second);
+        student_cache_lookup.erase(it);
+    }
+    student_cache_lru.push_front({path, {record, mtime, size}});
+    student_cache_lookup[path] = student_cache_lru.begin();
+    while (student_cache_lru.size() > STUDENT_CACHE_CAPACITY) {
+        student_cache_lookup.erase(student_cache_lru.back().first);
+        student_cache_lru.pop_back();
+    }
+}
+
+void studentCacheInvalidate(const string& path) {
+    lock_guard<mutex> lock(student_cache_mutex);
+    auto it = student_cache_lookup.find(path);
+    if (it == student_cache_lookup.end()) return;
+    student_cache_lru.erase(it->second);
+    student_cache_lookup.erase(it);
+}
+
+// Bytes a text-mode stream puts on disk for text ("\r\n" line endings on Windows)
+uintmax_t textBytesOnDisk(const string& text) {
+    uintmax_t bytes = text.size();
+#ifdef _WIN32
+    bytes += count(text.begin(), text.end(), '\n');
+#endif
+    return bytes;
+}
+
+// Write-through after this program has written the file itself. expected_size is what our own write
+// left on disk; any other size means another process wrote in between, so the entry is dropped instead.
+void studentCacheRefresh(const string& path, const student& record, uintmax_t expected_size) {
+    filesystem::file_time_type mtime;
+    uintmax_t size;
+    if (statStudentFile(path, mtime, size) && size == expected_size) studentCachePut(path, record, mtime, size);
+    else studentCacheInvalidate(path);
+}
+
+// Reads the class/ folder concurrently at startup so the first pass over a class does not wait on each open
+void warmStudentCache() {
+    vector<pair<string, string>> files; // (NISN, Name) from <NISN>_<Name>.txt
+    error_code ec;
+    for (const auto& dir_entry : filesystem::directory_iterator(student_details_folder, ec)) {
+        string file_stem = dir_entry.path().stem().string();
+        size_t underscore_pos = file_stem.find('_');
+        int nisn_int;
+        if (underscore_pos == string::npos || !isValidNisn(file_stem.substr(0, underscore_pos), nisn_int)) continue;
+        files.push_back({file_stem.substr(0, underscore_pos), file_stem.substr(underscore_pos + 1)});
+        if (files.size() >= STUDENT_CACHE_CAPACITY) break; // Anything beyond this would just be evicted
+    }
+    if (files.empty()) return;
+
+    unsigned int num_workers = thread::hardware_concurrency();
+    if (num_workers == 0) num_workers = 2;
+    num_workers = min<unsigned int>({num_workers * 2, 16, static_cast<unsigned int>(files.size())}); // I/O bound, oversubscribe a little
+    atomic<size_t> next_file(0);
+    vector<thread> workers;
+    for (unsigned int w = 0; w < num_workers; w++) {
+        workers.emplace_back([&files, &next_file]() {
+            student s_detail;
+            for (size_t i = next_file++; i < files.size(); i = next_file++) {
+                loadStudentDetailForConduct(s_detail, files[i].first, files[i].second);
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+}
+
+// Parses the "Key: value" lines of a student detail file
+void parseStudentDetail(istream& in, student& s_detail) {
+    string line;
+    bool conduct_section = false;
+    while (getline(in, line)) {
+        trimCarriageReturn(line);
+        if (line.rfind("Name: ", 0) == 0) s_detail.name = line.substr(6);
+        else if (line.rfind("NISN: ", 0) == 0) { /* NISN from param */ }
+        else if (line.rfind("Place of Birth: ", 0) == 0) s_detail.placeofbirth = line.substr(16);
+        else if (line.rfind("Date of Birth: ", 0) == 0) s_detail.dateofbirth = line.substr(15);
+        else if (line.rfind("Gender: ", 0) == 0) s_detail.gender = line.substr(8);
+        else if (line.rfind("Admission Grade: ", 0) == 0) {
+            try { s_detail.grade = stof(line.substr(17)); } catch(...) { s_detail.grade = 0.0f; }
+        }
+        else if (line.rfind("Subject: ", 0) == 0) {
+            size_t subject_pos = line.find("Subject: ");
+            size_t grade_pos = line.find(", Grade: ");
+            if (subject_pos != string::npos && grade_pos != string::npos && grade_pos > subject_pos) {
+                string sn = line.substr(subject_pos + string("Subject: ").length(), grade_pos - (subject_pos + string("Subject: ").length()));
+                string gs_str = line.substr(grade_pos + string(", Grade: ").length());
+                try {
+                    int gv_int = stoi(gs_str);
+                    s_detail.subject_grades.push_back({sn, gv_int});
+                } catch (...) { /* ignore parsing error */ }
+            }
+        }
+        else if (line == "--- Conduct Log ---") {
+            conduct_section = true;
+            continue;
+        }
+        if (conduct_section) {
+            if (!line.empty() && line.rfind("Log: ", 0) == 0) {
+                s_detail.conduct_log.push_back(line);
+            }
+        }
+    }
+}
+
+// Returns false when the student has no detail file yet
+bool loadStudentDetailForConduct(student& s_detail, const string& nisn_str_param, const string& name_param) {
     s_detail.NISN = stoi(nisn_str_param);
     s_detail.name = name_param;
     s_detail.conduct_log.clear();
@@ -398,70 +983,52 @@ void loadStudentDetailForConduct(student& s_detail, const string& nisn_str_param
     s_detail.grade = 0.0f;
 
     string student_file_path = student_details_folder + nisn_str_param + "_" + name_param + ".txt";
-    ifstream ifs_load_detail(student_file_path);
-    if (ifs_load_detail.is_open()) {
-        string line;
-        bool conduct_section = false;
-        while (getline(ifs_load_detail, line)) {
-            if (line.rfind("Name: ", 0) == 0) s_detail.name = line.substr(6);
-            else if (line.rfind("NISN: ", 0) == 0) { /* NISN from param */ }
-            else if (line.rfind("Place of Birth: ", 0) == 0) s_detail.placeofbirth = line.substr(16);
-            else if (line.rfind("Date of Birth: ", 0) == 0) s_detail.dateofbirth = line.substr(15);
-            else if (line.rfind("Gender: ", 0) == 0) s_detail.gender = line.substr(8);
-            else if (line.rfind("Admission Grade: ", 0) == 0) {
-                try { s_detail.grade = stof(line.substr(17)); } catch(...) { s_detail.grade = 0.0f; }
-            }
-            else if (line.rfind("Subject: ", 0) == 0) {
-                size_t subject_pos = line.find("Subject: ");
-                size_t grade_pos = line.find(", Grade: ");
-                if (subject_pos != string::npos && grade_pos != string::npos && grade_pos > subject_pos) {
-                    string sn = line.substr(subject_pos + string("Subject: ").length(), grade_pos - (subject_pos + string("Subject: ").length()));
-                    string gs_str = line.substr(grade_pos + string(", Grade: ").length());
-                    try {
-                        int gv_int = stoi(gs_str);
-                        s_detail.subject_grades.push_back({sn, gv_int});
-                    } catch (...) { /* ignore parsing error */ }
-                }
-            }
-            else if (line == "--- Conduct Log ---") {
-                conduct_section = true;
-                continue;
-            }
-            if (conduct_section) {
-                if (!line.empty() && line.rfind("Log: ", 0) == 0) {
-                    s_detail.conduct_log.push_back(line);
-                }
-            }
-        }
-        ifs_load_detail.close();
+    if (studentCacheGet(student_file_path, s_detail)) {
+        s_detail.NISN = stoi(nisn_str_param);
+        return true;
     }
+
+    filesystem::file_time_type mtime;
+    uintmax_t size;
+    if (!statStudentFile(student_file_path, mtime, size)) return false;
+    ifstream ifs_load_detail(student_file_path);
+    if (!ifs_load_detail.is_open()) return false;
+    parseStudentDetail(ifs_load_detail, s_detail);
+    ifs_load_detail.close();
+    studentCachePut(student_file_path, s_detail, mtime, size);
+    return true;
 }
 
 void saveStudentDetailWithConduct(const student& s_detail) {
     string student_file_path = student_details_folder + to_string(s_detail.NISN) + "_" + s_detail.name + ".txt";
-    ofstream ofs_save_detail(student_file_path, ios::out);
-    if (!ofs_save_detail.is_open()) {
-        cout << "Error: Failed to open file " << student_file_path << " for saving details." << endl;
-        return;
-    }
-    ofs_save_detail << "Name: " << s_detail.name << endl;
-    ofs_save_detail << "NISN: " << s_detail.NISN << endl;
-    ofs_save_detail << "Place of Birth: " << s_detail.placeofbirth << endl;
-    ofs_save_detail << "Date of Birth: " << s_detail.dateofbirth << endl;
-    ofs_save_detail << "Gender: " << s_detail.gender << endl;
-    ofs_save_detail << "Admission Grade: " << s_detail.grade << endl;
+    stringstream detail_text;
+    detail_text << "Name: " << s_detail.name << "\n";
+    detail_text << "NISN: " << s_detail.NISN << "\n";
+    detail_text << "Place of Birth: " << s_detail.placeofbirth << "\n";
+    detail_text << "Date of Birth: " << s_detail.dateofbirth << "\n";
+    detail_text << "Gender: " << s_detail.gender << "\n";
+    detail_text << "Admission Grade: " << s_detail.grade << "\n";
 
     for(const auto& sg : s_detail.subject_grades) {
-        ofs_save_detail << "Subject: " << sg.first << ", Grade: " << sg.second << endl;
+        detail_text << "Subject: " << sg.first << ", Grade: " << sg.second << "\n";
     }
 
     if (!s_detail.conduct_log.empty()) {
-        ofs_save_detail << "--- Conduct Log ---" << endl;
+        detail_text << "--- Conduct Log ---" << "\n";
         for (const string& log_entry : s_detail.conduct_log) {
-            ofs_save_detail << log_entry << endl;
+            detail_text << log_entry << "\n";
         }
     }
+
+    ofstream ofs_save_detail(student_file_path, ios::out);
+    if (!ofs_save_detail.is_open()) {
+        cout << "Error: Failed to open file " << student_file_path << " for saving details." << endl;
+        return;
+    }
+    string detail_lines = detail_text.str();
+    ofs_save_detail << detail_lines;
     ofs_save_detail.close();
+    studentCacheRefresh(student_file_path, s_detail, textBytesOnDisk(detail_lines));
 }
 
 void addConductNote() {
@@ -469,7 +1036,7 @@ void addConductNote() {
     ifstream ifs_add_note_loader(main_student_data_file);
     if (!ifs_add_note_loader.is_open()) { cout << "Error: Failed to open " << main_student_data_file << endl; return; }
     string n, ni;
-    while (getline(ifs_add_note_loader, ni) && getline(ifs_add_note_loader, n)) { current_accepted_students.push_back({n, ni}); }
+    while (getline(ifs_add_note_loader, ni) && getline(ifs_add_note_loader, n)) { trimCarriageReturn(ni); trimCarriageReturn(n); current_accepted_students.push_back({n, ni}); }
     ifs_add_note_loader.close();
     if (current_accepted_students.empty()) { cout << "No admitted students found." << endl; return; }
 
@@ -497,8 +1064,15 @@ void addConductNote() {
     string full_note = "Log: Date: " + date + ", Type: " + type + ", Note: " + note_desc;
     student_to_update.conduct_log.push_back(full_note);
     
+    ensureConductIndex(); // Load or rebuild before saving, so a rebuild cannot pick up the new note twice
+    ChangeLogLock_t change_log_lock;
     saveStudentDetailWithConduct(student_to_update);
 
+    ConductIndexEntry_t index_entry = {student_to_update.NISN, student_to_update.name,
+                                       static_cast<int>(student_to_update.conduct_log.size()) - 1, date, type};
+    appendConductIndexEntry(index_entry); // Picked up from the file by the next query, like other sessions' notes
+    recordChange("CONDUCT", {to_string(student_to_update.NISN), student_to_update.name, full_note});
+
     cout << "Conduct note added for " << student_to_update.name << "." << endl;
 }
 
@@ -507,7 +1081,7 @@ void viewConductNotes() {
     ifstream ifs_view_notes_loader(main_student_data_file);
     if (!ifs_view_notes_loader.is_open()) { cout << "Error: Failed to open " << main_student_data_file << endl; return; }
     string n, ni;
-    while (getline(ifs_view_notes_loader, ni) && getline(ifs_view_notes_loader, n)) { current_accepted_students.push_back({n, ni}); }
+    while (getline(ifs_view_notes_loader, ni) && getline(ifs_view_notes_loader, n)) { trimCarriageReturn(ni); trimCarriageReturn(n); current_accepted_students.push_back({n, ni}); }
     ifs_view_notes_loader.close();
     if (current_accepted_students.empty()) { cout << "No admitted students found." << endl; return; }
 
@@ -533,6 +1107,7 @@ void viewConductNotes() {
     bool in_conduct_section = false;
     bool found_logs = false;
     while (getline(ifs_view_student_file, line)) {
+        trimCarriageReturn(line);
         if (line == "--- Conduct Log ---") {
             in_conduct_section = true;
             continue;
@@ -551,6 +1126,251 @@ void viewConductNotes() {
     }
 }
 
+// --- Conduct log inverted index ---
+
+// Splits "Log: Date: <date>, Type: <type>, Note: <note>" into its fields
+bool parseConductLogLine(const string& log_line, string& out_date, string& out_type, string& out_note) {
+    const string date_tag = "Log: Date: ", type_tag = ", Type: ", note_tag = ", Note: ";
+    if (log_line.rfind(date_tag, 0) != 0) return false;
+    size_t type_pos = log_line.find(type_tag, date_tag.length());
+    if (type_pos == string::npos) return false;
+    size_t note_pos = log_line.find(note_tag, type_pos + type_tag.length());
+    if (note_pos == string::npos) return false;
+    out_date = log_line.substr(date_tag.length(), type_pos - date_tag.length());
+    out_type = log_line.substr(type_pos + type_tag.length(), note_pos - (type_pos + type_tag.length()));
+    out_note = log_line.substr(note_pos + note_tag.length());
+    return true;
+}
+
+static string toLowerCopy(string text) {
+    transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return text;
+}
+
+// Adds an entry to the in-memory buckets only
+void addConductIndexEntry(const ConductIndexEntry_t& entry) {
+    size_t pos = conduct_index_entries.size();
+    conduct_index_entries.push_back(entry);
+    conduct_index_by_date[entry.date].push_back(pos);
+    conduct_index_by_type[toLowerCopy(entry.type)].push_back(pos);
+}
+
+// Index line format: NISN|Name|NoteOffset|Date|Type
+bool appendConductIndexEntry(const ConductIndexEntry_t& entry) {
+    ofstream ofs_index(conduct_index_file, ios::app);
+    if (!ofs_index.is_open()) { cout << "Error: Failed to open " << conduct_index_file << " for writing!" << endl; return false; }
+    ofs_index << entry.nisn << "|" << entry.name << "|" << entry.note_offset << "|" << entry.date << "|" << entry.type << endl;
+    ofs_index.close();
+    return true;
+}
+
+// Rebuilds the index from the conduct logs of every file in class/
+void rebuildConductIndex() {
+    conduct_index_entries.clear();
+    conduct_index_by_date.clear();
+    conduct_index_by_type.clear();
+
+    error_code ec;
+    for (const auto& dir_entry : filesystem::directory_iterator(student_details_folder, ec)) {
+        string file_stem = dir_entry.path().stem().string();
+        size_t underscore_pos = file_stem.find('_');
+        int nisn_int;
+        if (underscore_pos == string::npos || !isValidNisn(file_stem.substr(0, underscore_pos), nisn_int)) continue;
+
+        student s_detail;
+        loadStudentDetailForConduct(s_detail, file_stem.substr(0, underscore_pos), file_stem.substr(underscore_pos + 1));
+        for (size_t i = 0; i < s_detail.conduct_log.size(); i++) {
+            string date, type, note;
+            if (parseConductLogLine(s_detail.conduct_log[i], date, type, note)) {
+                addConductIndexEntry({nisn_int, file_stem.substr(underscore_pos + 1), static_cast<int>(i), date, type});
+            }
+        }
+    }
+
+    ofstream ofs_index(conduct_index_file, ios::out);
+    if (!ofs_index.is_open()) {
+        // Keep what was scanned; only lines appended to the old file from here on will be read
+        cout << "Error: Failed to open " << conduct_index_file << " for writing!" << endl;
+        error_code ec;
+        conduct_index_loaded_size = filesystem::file_size(conduct_index_file, ec);
+        if (ec) conduct_index_loaded_size = 0;
+        conduct_index_last_line.clear();
+        conduct_index_loaded = true;
+        return;
+    }
+    for (const ConductIndexEntry_t& e : conduct_index_entries) {
+        ofs_index << e.nisn << "|" << e.name << "|" << e.note_offset << "|" << e.date << "|" << e.type << endl;
+    }
+    ofs_index.close();
+    // Read back what was written so the byte position matches the file
+    conduct_index_loaded = false;
+    ensureConductIndex();
+}
+
+// Loads conduct_index.txt, rebuilding it from the logs when it does not exist yet. Later calls only read
+// the lines other sessions appended since; a file rewritten by another session's rebuild is read again.
+void ensureConductIndex() {
+    error_code ec;
+    uintmax_t index_size = filesystem::file_size(conduct_index_file, ec);
+    if (ec) {
+        if (!conduct_index_loaded) rebuildConductIndex();
+        return;
+    }
+    if (conduct_index_loaded && index_size == conduct_index_loaded_size) return;
+    ifstream ifs_index(conduct_index_file, ios::binary);
+    if (!ifs_index.is_open()) {
+        if (!conduct_index_loaded) rebuildConductIndex();
+        return;
+    }
+
+    bool appended_only = conduct_index_loaded && index_size > conduct_index_loaded_size;
+    if (appended_only && !conduct_index_last_line.empty()) {
+        string tail(conduct_index_last_line.size(), '\0');
+        ifs_index.seekg(conduct_index_loaded_size - tail.size());
+        appended_only = ifs_index.read(&tail[0], tail.size()) && tail == conduct_index_last_line;
+    }
+    if (!appended_only) {
+        conduct_index_entries.clear();
+        conduct_index_by_date.clear();
+        conduct_index_by_type.clear();
+        conduct_index_loaded_size = 0;
+        conduct_index_last_line.clear();
+    }
+    ifs_index.clear();
+    ifs_index.seekg(conduct_index_loaded_size);
+
+    string line;
+    while (getline(ifs_index, line)) {
+        if (ifs_index.eof()) break; // No newline yet, another session is still writing this line
+        conduct_index_loaded_size += line.size() + 1;
+        conduct_index_last_line = line + "\n";
+        trimCarriageReturn(line);
+        vector<string> fields;
+        size_t start = 0, bar_pos;
+        while (fields.size() < 4 && (bar_pos = line.find('|', start)) != string::npos) {
+            fields.push_back(line.substr(start, bar_pos - start));
+            start = bar_pos + 1;
+        }
+        fields.push_back(line.substr(start));
+        int nisn_int, offset_int;
+        if (fields.size() != 5 || !isValidNisn(fields[0], nisn_int) || !isValidCount(fields[2], offset_int)) continue;
+        addConductIndexEntry({nisn_int, fields[1], offset_int, fields[3], fields[4]});
+    }
+    ifs_index.close();
+    conduct_index_loaded = true;
+}
+
+// Entry positions matching the type (empty = any) whose date lies in [date_from, date_to].
+// Bounds compare as prefixes, so "2026-09" to "2026-09" covers the whole month.
+vector<size_t> queryConductIndex(const string& type_filter, const string& date_from, const string& date_to) {
+    ensureConductIndex();
+    vector<size_t> matches;
+    string type_key = toLowerCopy(type_filter);
+    auto in_date_range = [&](const string& date) {
+        if (!date_from.empty() && date < date_from) return false;
+        if (!date_to.empty() && date.compare(0, date_to.length(), date_to) > 0) return false;
+        return true;
+    };
+
+    if (!type_key.empty() && date_from.empty() && date_to.empty()) {
+        auto type_it = conduct_index_by_type.find(type_key);
+        if (type_it != conduct_index_by_type.end()) matches = type_it->second;
+    } else {
+        auto date_it = date_from.empty() ? conduct_index_by_date.begin() : conduct_index_by_date.lower_bound(date_from);
+        for (; date_it != conduct_index_by_date.end() && in_date_range(date_it->first); ++date_it) {
+            for (size_t pos : date_it->second) {
+                if (type_key.empty() || toLowerCopy(conduct_index_entries[pos].type) == type_key) matches.push_back(pos);
+            }
+        }
+    }
+    return matches;
+}
+
+void searchConductNotes() {
+    string type_filter, date_from, date_to;
+    cout << "\n--- Search Conduct Notes (All Students) ---" << endl;
+    cout << "Note type (blank for any): "; getline(cin, type_filter);
+    cout << "From date (YYYY-MM-DD or YYYY-MM, blank for earliest): "; getline(cin, date_from);
+    cout << "To date (YYYY-MM-DD or YYYY-MM, blank for latest): "; getline(cin, date_to);
+
+    vector<size_t> matches = queryConductIndex(type_filter, date_from, date_to);
+    if (matches.empty()) { cout << "No conduct notes match." << endl; return; }
+
+    // Only the files of matching students are opened to show the note text
+    map<int, student> loaded_students;
+    for (size_t pos : matches) {
+        const ConductIndexEntry_t& e = conduct_index_entries[pos];
+        auto student_it = loaded_students.find(e.nisn);
+        if (student_it == loaded_students.end()) {
+            student_it = loaded_students.emplace(e.nisn, student()).first;
+            loadStudentDetailForConduct(student_it->second, to_string(e.nisn), e.name);
+        }
+        string date, type, note;
+        const vector<string>& log = student_it->second.conduct_log;
+        bool note_matches = e.note_offset < static_cast<int>(log.size()) &&
+                            parseConductLogLine(log[e.note_offset], date, type, note) &&
+                            date == e.date && type == e.type; // The file may have been rewritten since the note was indexed
+        if (!note_matches) note = "[note missing, rebuild the conduct index]";
+        cout << e.date << " | " << e.type << " | " << e.name << " (NISN: " << e.nisn << ") | " << note << endl;
+    }
+    cout << matches.size() << " note(s) found." << endl;
+}
+
+void reportRepeatConductNotes() {
+    string type_filter, date_from, date_to;
+    int min_count;
+    cout << "\n--- Students with Repeated Conduct Notes ---" << endl;
+    cout << "Note type (e.g., Warning): "; getline(cin, type_filter);
+    cout << "From date (YYYY-MM-DD or YYYY-MM, blank for earliest): "; getline(cin, date_from);
+    cout << "To date (YYYY-MM-DD or YYYY-MM, blank for latest): "; getline(cin, date_to);
+    cout << "Minimum number of notes: ";
+    while (!(cin >> min_count) || min_count < 1) {
+        cout << "Invalid number. Please enter a positive number: "; cin.clear(); clearInputBuffer();
+    }
+    clearInputBuffer();
+
+    map<int, pair<string, int>> counts; // NISN -> (name, note count)
+    for (size_t pos : queryConductIndex(type_filter, date_from, date_to)) {
+        const ConductIndexEntry_t& e = conduct_index_entries[pos];
+        counts[e.nisn].first = e.name;
+        counts[e.nisn].second++;
+    }
+    bool any_found = false;
+    for (const auto& c : counts) {
+        if (c.second.second >= min_count) {
+            cout << c.second.first << " (NISN: " << c.first << "): " << c.second.second << " note(s)" << endl;
+            any_found = true;
+        }
+    }
+    if (!any_found) cout << "No students have " << min_count << " or more matching notes." << endl;
+}
+
+// Helper function to parse the "<name...> <paid> <unpaid>" remainder of a tuition.txt line
+bool parseTuitionLine(int file_id, const string& line_content, TuitionRecord_t& out_record) {
+    stringstream ss(line_content);
+    vector<string> tokens;
+    string token_item;
+    while (ss >> token_item) {
+        tokens.push_back(token_item);
+    }
+    if (tokens.size() < 2) return false; // Need at least 2 tokens for paid amount and unpaid balance
+    try {
+        string unpaid_str = tokens.back(); tokens.pop_back();
+        string paid_str = tokens.back(); tokens.pop_back();
+        out_record.unpaid_balance = stoi(unpaid_str);
+        out_record.paid_this_transaction = stoi(paid_str);
+    } catch (const std::exception& e) {
+        return false; // Malformed line
+    }
+    out_record.id = file_id;
+    out_record.name = "";
+    for (const string& name_part : tokens) {
+        if (!out_record.name.empty()) out_record.name += " ";
+        out_record.name += name_part;
+    }
+    return true;
+}
+
 // Helper function to get the latest tuition record for a student
 bool getLatestTuitionRecordForPayment(int nisn_to_search, string& out_student_name, int& out_outstanding_balance) {
     ifstream tuition_ifs(tuition_file);
@@ -561,56 +1381,44 @@ bool getLatestTuitionRecordForPayment(int nisn_to_search, string& out_student_na
     int file_id;
     string line_content;
     bool record_found_for_nisn = false;
-    
-    // Temporary variables to store the details of the last found record for the specific NISN
-    int latest_unpaid_temp = 0;
-    string latest_name_temp = "";
+    TuitionRecord_t latest_record_temp = {0, "", 0, 0};
 
     while (tuition_ifs >> file_id >> ws && getline(tuition_ifs, line_content)) {
         if (file_id == nisn_to_search) {
-            stringstream ss(line_content);
-            vector<string> tokens;
-            string token_item;
-            while (ss >> token_item) {
-                tokens.push_back(token_item);
-            }
-
-            if (tokens.size() >= 2) { // Need at least 2 tokens for paid amount and unpaid balance
-                string name_for_this_line;
-                int paid_for_this_line, unpaid_for_this_line;
-                try {
-                    string unpaid_str = tokens.back(); tokens.pop_back();
-                    if (tokens.empty()) continue; 
-                    string paid_str = tokens.back(); tokens.pop_back();
-                    
-                    unpaid_for_this_line = stoi(unpaid_str);
-                    // paid_for_this_line = stoi(paid_str); // Amount paid in that transaction, not needed for next calculation
-
-                    for (const string& name_part : tokens) {
-                        if (!name_for_this_line.empty()) name_for_this_line += " ";
-                        name_for_this_line += name_part;
-                    }
-                    
-                    record_found_for_nisn = true;
-                    latest_unpaid_temp = unpaid_for_this_line;
-                    latest_name_temp = name_for_this_line;
-                } catch (const std::exception& e) {
-                    // Skip malformed line
-                    continue;
-                }
+            TuitionRecord_t record_for_this_line;
+            if (parseTuitionLine(file_id, line_content, record_for_this_line)) {
+                record_found_for_nisn = true;
+                latest_record_temp = record_for_this_line;
             }
         }
     }
     tuition_ifs.close();
 
     if (record_found_for_nisn) {
-        out_outstanding_balance = latest_unpaid_temp;
-        out_student_name = latest_name_temp;
+        out_outstanding_balance = latest_record_temp.unpaid_balance;
+        out_student_name = latest_record_temp.name;
         return true;
     }
     return false; 
 }
 
+// Helper function to load the latest tuition record of every NISN in a single pass over tuition.txt
+void loadLatestTuitionRecords(unordered_map<int, TuitionRecord_t>& out_latest) {
+    out_latest.clear();
+    ifstream tuition_ifs(tuition_file);
+    if (!tuition_ifs.is_open()) return; // No file, so no previous records
+
+    int file_id;
+    string line_content;
+    while (tuition_ifs >> file_id >> ws && getline(tuition_ifs, line_content)) {
+        TuitionRecord_t record_for_this_line;
+        if (parseTuitionLine(file_id, line_content, record_for_this_line)) {
+            out_latest[file_id] = record_for_this_line; // Later lines overwrite earlier ones
+        }
+    }
+    tuition_ifs.close();
+}
+
 void payTuition() {
     string student_nisn_str;
     int student_nisn_int;
@@ -672,11 +1480,13 @@ void payTuition() {
         cout << "New outstanding balance: " << new_outstanding_balance << endl;
     }
 
+    ChangeLogLock_t change_log_lock;
     ofstream ofs_local_tuition;
     ofs_local_tuition.open(tuition_file, ios::app);
     if (!ofs_local_tuition.is_open()) { cout << "Error: Failed to open " << tuition_file << " for writing!" << endl; return; }
     ofs_local_tuition << student_nisn_int << " " << name_to_record << " " << amount_paid_this_transaction << " " << new_outstanding_balance << endl; 
     ofs_local_tuition.close();
+    recordChange("PAY", {to_string(student_nisn_int), name_to_record, to_string(amount_paid_this_transaction), to_string(new_outstanding_balance)});
     cout << "Tuition payment record saved." << endl;
 }
 
@@ -755,6 +1565,161 @@ void searchTuitionStatus() { // This function's logic remains largely the same
     }
 }
 
+// Worker for importBankStatement: applies the rows of one NISN partition in statement order.
+// Every NISN lives in exactly one partition, so running balances never need locking.
+void reconcileStatementPartition(const vector<StatementRow_t>& rows, const vector<size_t>& row_indices,
+                                 const unordered_map<int, TuitionRecord_t>& latest_records,
+                                 const unordered_map<int, string>& roster_names,
+                                 vector<ReconcileResult_t>& results) {
+    unordered_map<int, TuitionRecord_t> running; // Balance after the rows applied so far in this partition
+    for (size_t idx : row_indices) {
+        const StatementRow_t& row = rows[idx];
+        ReconcileResult_t& result = results[idx];
+        result.applied = false;
+
+        auto run_it = running.find(row.nisn);
+        if (run_it == running.end()) {
+            auto ledger_it = latest_records.find(row.nisn);
+            if (ledger_it != latest_records.end()) {
+                run_it = running.emplace(row.nisn, ledger_it->second).first;
+            } else {
+                auto roster_it = roster_names.find(row.nisn);
+                if (roster_it == roster_names.end()) {
+                    result.exception_reason = "Unmatched: NISN not found in roster or tuition ledger";
+                    continue;
+                }
+                run_it = running.emplace(row.nisn, TuitionRecord_t{row.nisn, roster_it->second, 0, BASE_TUITION}).first;
+            }
+        }
+
+        TuitionRecord_t& current = run_it->second;
+        if (row.amount <= 0) {
+            result.exception_reason = "Invalid amount";
+        } else if (current.unpaid_balance == 0) {
+            result.exception_reason = "Overpaid: tuition already fully paid (excess " + to_string(row.amount) + ")";
+        } else if (row.amount > current.unpaid_balance) {
+            result.exception_reason = "Overpaid: outstanding " + to_string(current.unpaid_balance) +
+                                      ", excess " + to_string(row.amount - current.unpaid_balance);
+        } else {
+            current.paid_this_transaction = row.amount;
+            current.unpaid_balance -= row.amount;
+            result.applied = true;
+            result.record = current;
+        }
+    }
+}
+
+void importBankStatement() {
+    cout << "\n--- Import Bank Statement (Reconciliation) ---" << endl;
+    cout << "Each row: <NISN> [reference...] <amount>" << endl;
+    cout << "Amount formats: 1000000, 1.000.000, 1,000,000, 1000000.00, 1.000.000,00" << endl;
+    string statement_path;
+    cout << "Please enter the statement file path: ";
+    getline(cin, statement_path);
+
+    ifstream ifs_statement(statement_path);
+    if (!ifs_statement.is_open()) { cout << "Error: Failed to open " << statement_path << "!" << endl; return; }
+
+    vector<StatementRow_t> rows;
+    vector<pair<size_t, string>> exception_rows; // (row number, report line)
+    string line;
+    size_t line_no = 0;
+    while (getline(ifs_statement, line)) {
+        line_no++;
+        trimCarriageReturn(line);
+        stringstream ss(line);
+        vector<string> tokens;
+        string token_item;
+        while (ss >> token_item) tokens.push_back(token_item);
+        if (tokens.empty() || tokens[0][0] == '#') continue; // Blank line or comment
+
+        int nisn_int, amount_int;
+        if (tokens.size() < 2 || !isValidNisn(tokens[0], nisn_int) || !isValidAmount(tokens.back(), amount_int)) {
+            exception_rows.push_back({line_no, "Row " + to_string(line_no) + ": " + line + " -> Malformed row"});
+            continue;
+        }
+        rows.push_back({line_no, nisn_int, amount_int, line});
+    }
+    ifs_statement.close();
+
+    // One pass over each data file instead of one ledger scan per payment
+    unordered_map<int, TuitionRecord_t> latest_records;
+    loadLatestTuitionRecords(latest_records);
+
+    unordered_map<int, string> roster_names;
+    ifstream ifs_roster(main_student_data_file);
+    if (ifs_roster.is_open()) {
+        string ni, n;
+        int ni_int;
+        while (getline(ifs_roster, ni) && getline(ifs_roster, n)) {
+            trimCarriageReturn(ni); trimCarriageReturn(n);
+            if (isValidNisn(ni, ni_int)) roster_names[ni_int] = n;
+        }
+        ifs_roster.close();
+    }
+
+    // Partition rows by NISN so each student's payments stay ordered inside a single worker
+    unsigned int num_workers = thread::hardware_concurrency();
+    if (num_workers == 0) num_workers = 2;
+    if (num_workers > rows.size()) num_workers = rows.empty() ? 1 : static_cast<unsigned int>(rows.size());
+    vector<vector<size_t>> partitions(num_workers);
+    for (size_t i = 0; i < rows.size(); i++) {
+        partitions[static_cast<unsigned int>(rows[i].nisn) % num_workers].push_back(i);
+    }
+
+    vector<ReconcileResult_t> results(rows.size());
+    vector<thread> workers;
+    for (unsigned int w = 0; w < num_workers; w++) {
+        if (partitions[w].empty()) continue;
+        workers.emplace_back(reconcileStatementPartition, cref(rows), cref(partitions[w]),
+                             cref(latest_records), cref(roster_names), ref(results));
+    }
+    for (thread& worker : workers) worker.join();
+
+    // Batch the ledger lines and exceptions in statement order, then write each file once
+    stringstream ledger_batch, exceptions_batch;
+    vector<vector<string>> payment_changes;
+    int applied_count = 0;
+    long long applied_total = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (results[i].applied) {
+            const TuitionRecord_t& r = results[i].record;
+            ledger_batch << r.id << " " << r.name << " " << r.paid_this_transaction << " " << r.unpaid_balance << endl;
+            payment_changes.push_back({to_string(r.id), r.name, to_string(r.paid_this_transaction), to_string(r.unpaid_balance)});
+            applied_count++;
+            applied_total += r.paid_this_transaction;
+        } else {
+            exception_rows.push_back({rows[i].row_no, "Row " + to_string(rows[i].row_no) + ": " + rows[i].raw_line + " -> " + results[i].exception_reason});
+        }
+    }
+    sort(exception_rows.begin(), exception_rows.end());
+    for (const auto& e : exception_rows) exceptions_batch << e.second << endl;
+    int exception_count = static_cast<int>(exception_rows.size());
+
+    if (applied_count > 0) {
+        ChangeLogLock_t change_log_lock;
+        ofstream ofs_local_tuition(tuition_file, ios::app);
+        if (!ofs_local_tuition.is_open()) { cout << "Error: Failed to open " << tuition_file << " for writing!" << endl; return; }
+        ofs_local_tuition << ledger_batch.str();
+        ofs_local_tuition.close();
+        recordChanges("PAY", payment_changes);
+    }
+    if (exception_count > 0) {
+        ofstream ofs_exceptions(tuition_exceptions_file, ios::app);
+        if (!ofs_exceptions.is_open()) { cout << "Error: Failed to open " << tuition_exceptions_file << " for writing!" << endl; }
+        else {
+            ofs_exceptions << "=== Statement: " << statement_path << " ===" << endl;
+            ofs_exceptions << exceptions_batch.str();
+            ofs_exceptions.close();
+        }
+    }
+
+    cout << "Rows applied: " << applied_count << " (total " << applied_total << ")" << endl;
+    cout << "Rows sent to exceptions: " << exception_count;
+    if (exception_count > 0) cout << " (see " << tuition_exceptions_file << ")";
+    cout << endl;
+}
+
 void menuTuition() {
     int choice;
     do {
@@ -763,7 +1728,8 @@ void menuTuition() {
         cout << "+=========================+" << endl;
         cout << "1. Pay Tuition" << endl;
         cout << "2. Search Student's Tuition Status" << endl;
-        cout << "3. Back to Main Menu" << endl;
+        cout << "3. Import Bank Statement (Reconciliation)" << endl;
+        cout << "4. Back to Main Menu" << endl;
         cout << "Choose a service: ";
         while (!(cin >> choice)) {
             cout << "Invalid input. Please enter a number: "; cin.clear(); clearInputBuffer();
@@ -771,13 +1737,730 @@ void menuTuition() {
         switch (choice) {
             case 1: payTuition(); break;
             case 2: searchTuitionStatus(); break;
-            case 3: cout << "Returning to Main Menu..." << endl; break;
+            case 3: importBankStatement(); break;
+            case 4: cout << "Returning to Main Menu..." << endl; break;
+            default: cout << "Invalid choice. Please try again!" << endl;
+        } if(choice != 4) { cout << "Press Enter to continue..."; cin.get(); }
+    } while (choice != 4);
+}
+
+// --- Columnar export for offline analytics ---
+
+static bool openExportPlainFiles(ExportColumn_t& col) {
+    col.plain_offsets_out.open(col.base_path + ".off", ios::out | ios::binary);
+    col.plain_bytes_out.open(col.base_path + ".bin", ios::out | ios::binary);
+    if (!col.plain_offsets_out.is_open() || !col.plain_bytes_out.is_open()) {
+        cout << "Error: Failed to open plain string files for " << col.base_path << "!" << endl; return false;
+    }
+    col.plain_offsets_out.write(reinterpret_cast<const char*>(&col.plain_bytes_written), sizeof(uint64_t));
+    return true;
+}
+
+bool openExportTable(ExportTable_t& table, const string& folder, const string& table_name,
+                     const vector<pair<string, char>>& column_defs, bool with_csv) {
+    table.name = table_name;
+    table.columns = vector<ExportColumn_t>(column_defs.size());
+    for (size_t c = 0; c < column_defs.size(); c++) {
+        ExportColumn_t& col = table.columns[c];
+        col.name = column_defs[c].first;
+        col.type = column_defs[c].second;
+        col.base_path = folder + table_name + "." + col.name;
+        if (col.type == 'p') {
+            col.plain = true;
+            if (!openExportPlainFiles(col)) return false;
+            continue;
+        }
+        string data_path = col.base_path + (col.type == 'i' ? ".i32" : col.type == 'f' ? ".f32" : ".u32");
+        col.data_out.open(data_path, ios::out | ios::binary);
+        if (!col.data_out.is_open()) { cout << "Error: Failed to open " << data_path << " for writing!" << endl; return false; }
+        if (col.type == 's') {
+            col.dict_offsets_out.open(col.base_path + ".dict.off", ios::out | ios::binary);
+            col.dict_bytes_out.open(col.base_path + ".dict.bin", ios::out | ios::binary);
+            if (!col.dict_offsets_out.is_open() || !col.dict_bytes_out.is_open()) {
+                cout << "Error: Failed to open dictionary files for " << col.base_path << "!" << endl; return false;
+            }
+            col.dict_offsets_out.write(reinterpret_cast<const char*>(&col.dict_bytes_written), sizeof(uint64_t));
+        } else {
+            col.group_buffer.reserve(EXPORT_ROW_GROUP_SIZE * 4);
+        }
+    }
+    if (with_csv) {
+        string csv_path = folder + table_name + ".csv";
+        table.csv_out.open(csv_path, ios::out);
+        if (!table.csv_out.is_open()) { cout << "Error: Failed to open " << csv_path << " for writing!" << endl; return false; }
+        for (size_t c = 0; c < table.columns.size(); c++) table.csv_out << (c ? "," : "") << table.columns[c].name;
+        table.csv_out << "\n";
+    }
+    return true;
+}
+
+static void exportAppendCsvCell(ExportTable_t& table, const string& cell) {
+    if (!table.csv_out.is_open()) return;
+    if (!table.csv_row.empty()) table.csv_row += ",";
+    if (cell.find_first_of(",\"\n") == string::npos) { table.csv_row += cell; return; }
+    table.csv_row += "\"";
+    for (char ch : cell) { if (ch == '"') table.csv_row += "\""; table.csv_row += ch; }
+    table.csv_row += "\"";
+}
+
+void exportPutInt(ExportTable_t& table, size_t col, int value) {
+    int32_t v = value;
+    const char* bytes = reinterpret_cast<const char*>(&v);
+    table.columns[col].group_buffer.insert(table.columns[col].group_buffer.end(), bytes, bytes + sizeof(v));
+    exportAppendCsvCell(table, to_string(value));
+}
+
+void exportPutFloat(ExportTable_t& table, size_t col, float value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    table.columns[col].group_buffer.insert(table.columns[col].group_buffer.end(), bytes, bytes + sizeof(value));
+    stringstream ss; ss << value;
+    exportAppendCsvCell(table, ss.str());
+}
+
+// Strings are only buffered here; the encoding is chosen per row group in flushExportStrings()
+void exportPutString(ExportTable_t& table, size_t col, const string& value) {
+    table.columns[col].group_strings.push_back(value);
+    exportAppendCsvCell(table, value);
+}
+
+static void flushExportStrings(ExportColumn_t& col, size_t group_first_row) {
+    if (!col.plain) {
+        unordered_set<string> new_values;
+        for (const string& value : col.group_strings) {
+            if (col.dictionary.count(value) == 0) new_values.insert(value);
+        }
+        if (col.dictionary.size() + new_values.size() > EXPORT_DICT_MAX_ENTRIES) {
+            // Too many distinct values to keep in memory: this and every later row group is written plain
+            col.plain = true;
+            col.first_plain_row = group_first_row;
+            if (!openExportPlainFiles(col)) { col.group_strings.clear(); return; }
+        } else {
+            vector<uint32_t> codes;
+            codes.reserve(col.group_strings.size());
+            for (const string& value : col.group_strings) {
+                auto dict_it = col.dictionary.find(value);
+                if (dict_it == col.dictionary.end()) {
+                    dict_it = col.dictionary.emplace(value, static_cast<uint32_t>(col.dictionary.size())).first;
+                    col.dict_bytes_out.write(value.data(), value.size());
+                    col.dict_bytes_written += value.size();
+                    col.dict_offsets_out.write(reinterpret_cast<const char*>(&col.dict_bytes_written), sizeof(uint64_t));
+                }
+                codes.push_back(dict_it->second);
+            }
+            col.data_out.write(reinterpret_cast<const char*>(codes.data()), codes.size() * sizeof(uint32_t));
+        }
+    }
+    if (col.plain) {
+        for (const string& value : col.group_strings) {
+            col.plain_bytes_out.write(value.data(), value.size());
+            col.plain_bytes_written += value.size();
+            col.plain_offsets_out.write(reinterpret_cast<const char*>(&col.plain_bytes_written), sizeof(uint64_t));
+        }
+    }
+    col.group_strings.clear();
+}
+
+static void flushExportRowGroup(ExportTable_t& table) {
+    if (table.rows_in_group == 0) return;
+    size_t group_first_row = table.row_count - table.rows_in_group;
+    for (ExportColumn_t& col : table.columns) {
+        if (col.type == 's' || col.type == 'p') { flushExportStrings(col, group_first_row); continue; }
+        col.data_out.write(col.group_buffer.data(), col.group_buffer.size());
+        col.group_buffer.clear();
+    }
+    table.row_group_count++;
+    table.rows_in_group = 0;
+}
+
+void exportEndRow(ExportTable_t& table) {
+    table.row_count++;
+    table.rows_in_group++;
+    if (table.csv_out.is_open()) { table.csv_out << table.csv_row << "\n"; table.csv_row.clear(); }
+    if (table.rows_in_group == EXPORT_ROW_GROUP_SIZE) flushExportRowGroup(table);
+}
+
+// Flushes the last row group and describes the table's files in the manifest:
+//   column <name> int32|float32 <file>
+//   column <name> string dict <codes.u32> <dict.off> <dict.bin> <entries>
+//   column <name> string plain <off> <bin>
+//   column <name> string dict_then_plain <first_plain_row> <codes.u32> <dict.off> <dict.bin> <entries> <off> <bin>
+void closeExportTable(ExportTable_t& table, ofstream& manifest_out) {
+    flushExportRowGroup(table);
+    manifest_out << "table " << table.name << " rows " << table.row_count << " row_groups " << table.row_group_count << endl;
+    for (ExportColumn_t& col : table.columns) {
+        string file_base = filesystem::path(col.base_path).filename().string();
+        manifest_out << "column " << col.name << " ";
+        if (col.type == 'i' || col.type == 'f') {
+            manifest_out << (col.type == 'i' ? "int32 " : "float32 ") << file_base << (col.type == 'i' ? ".i32" : ".f32") << endl;
+            col.data_out.close();
+            continue;
+        }
+        string dict_files = file_base + ".u32 " + file_base + ".dict.off " + file_base + ".dict.bin " + to_string(col.dictionary.size());
+        string plain_files = file_base + ".off " + file_base + ".bin";
+        if (col.data_out.is_open()) { col.data_out.close(); col.dict_offsets_out.close(); col.dict_bytes_out.close(); }
+        if (col.plain_offsets_out.is_open()) { col.plain_offsets_out.close(); col.plain_bytes_out.close(); }
+        if (!col.plain) {
+            manifest_out << "string dict " << dict_files << endl;
+        } else if (col.type == 'p' || col.first_plain_row == 0) {
+            if (col.type == 's') { // Overflowed in the first row group, the dictionary files hold nothing useful
+                error_code ec;
+                for (const char* ext : {".u32", ".dict.off", ".dict.bin"}) filesystem::remove(col.base_path + ext, ec);
+            }
+            manifest_out << "string plain " << plain_files << endl;
+        } else {
+            manifest_out << "string dict_then_plain " << col.first_plain_row << " " << dict_files << " " << plain_files << endl;
+        }
+    }
+    if (table.csv_out.is_open()) table.csv_out.close();
+}
+
+void exportSchoolData() {
+    string export_folder, with_csv_answer;
+    cout << "\n--- Export School Data (Columnar) ---" << endl;
+    cout << "Export folder (blank for " << export_default_folder << "): ";
+    getline(cin, export_folder);
+    if (export_folder.empty()) export_folder = export_default_folder;
+    if (export_folder.back() != '/' && export_folder.back() != '\\') export_folder += "/";
+    cout << "Also write CSV files? (y/n): ";
+    getline(cin, with_csv_answer);
+    bool with_csv = (with_csv_answer == "y" || with_csv_answer == "Y");
+
+    error_code ec;
+    filesystem::create_directories(export_folder, ec);
+    if (ec) { cout << "Error: Failed to create " << export_folder << "!" << endl; return; }
+
+    ExportTable_t students_table, grades_table, conduct_table, tuition_table;
+    if (!openExportTable(students_table, export_folder, "students",
+                         {{"nisn", 'i'}, {"name", 'p'}, {"place_of_birth", 'p'}, {"date_of_birth", 'p'}, {"gender", 's'}, {"admission_grade", 'f'}}, with_csv) ||
+        !openExportTable(grades_table, export_folder, "subject_grades", {{"nisn", 'i'}, {"subject", 's'}, {"grade", 'i'}}, with_csv) ||
+        !openExportTable(conduct_table, export_folder, "conduct_log", {{"nisn", 'i'}, {"date", 's'}, {"type", 's'}, {"note", 'p'}}, with_csv) ||
+        !openExportTable(tuition_table, export_folder, "tuition", {{"nisn", 'i'}, {"name", 'p'}, {"paid", 'i'}, {"unpaid", 'i'}}, with_csv)) {
+        return;
+    }
+
+    // Roster, grades and conduct logs are written in one streaming pass over the roster
+    ifstream ifs_roster(main_student_data_file);
+    if (ifs_roster.is_open()) {
+        string ni, n;
+        int nisn_int;
+        while (getline(ifs_roster, ni) && getline(ifs_roster, n)) {
+            trimCarriageReturn(ni); trimCarriageReturn(n);
+            if (!isValidNisn(ni, nisn_int)) continue;
+            student s_detail;
+            loadStudentDetailForConduct(s_detail, ni, n);
+
+            exportPutInt(students_table, 0, nisn_int);
+            exportPutString(students_table, 1, n);
+            exportPutString(students_table, 2, s_detail.placeofbirth);
+            exportPutString(students_table, 3, s_detail.dateofbirth);
+            exportPutString(students_table, 4, s_detail.gender);
+            exportPutFloat(students_table, 5, s_detail.grade);
+            exportEndRow(students_table);
+
+            for (const auto& sg : s_detail.subject_grades) {
+                exportPutInt(grades_table, 0, nisn_int);
+                exportPutString(grades_table, 1, sg.first);
+                exportPutInt(grades_table, 2, sg.second);
+                exportEndRow(grades_table);
+            }
+            for (const string& log_line : s_detail.conduct_log) {
+                string date, type, note;
+                if (!parseConductLogLine(log_line, date, type, note)) { note = log_line; }
+                exportPutInt(conduct_table, 0, nisn_int);
+                exportPutString(conduct_table, 1, date);
+                exportPutString(conduct_table, 2, type);
+                exportPutString(conduct_table, 3, note);
+                exportEndRow(conduct_table);
+            }
+        }
+        ifs_roster.close();
+    } else {
+        cout << "Warning: " << main_student_data_file << " not found, roster tables will be empty." << endl;
+    }
+
+    ifstream ifs_tuition(tuition_file);
+    if (ifs_tuition.is_open()) {
+        int file_id;
+        string line_content;
+        while (ifs_tuition >> file_id >> ws && getline(ifs_tuition, line_content)) {
+            TuitionRecord_t record;
+            if (!parseTuitionLine(file_id, line_content, record)) continue;
+            exportPutInt(tuition_table, 0, record.id);
+            exportPutString(tuition_table, 1, record.name);
+            exportPutInt(tuition_table, 2, record.paid_this_transaction);
+            exportPutInt(tuition_table, 3, record.unpaid_balance);
+            exportEndRow(tuition_table);
+        }
+        ifs_tuition.close();
+    }
+
+    string manifest_path = export_folder + "manifest.txt";
+    ofstream manifest_out(manifest_path, ios::out);
+    if (!manifest_out.is_open()) { cout << "Error: Failed to open " << manifest_path << " for writing!" << endl; return; }
+    uint16_t endian_probe = 1;
+    manifest_out << "format school-columnar 2" << endl;
+    manifest_out << "byte_order " << (*reinterpret_cast<uint8_t*>(&endian_probe) == 1 ? "little" : "big") << endl;
+    manifest_out << "row_group_size " << EXPORT_ROW_GROUP_SIZE << endl;
+    for (ExportTable_t* table : {&students_table, &grades_table, &conduct_table, &tuition_table}) {
+        closeExportTable(*table, manifest_out);
+    }
+    manifest_out.close();
+
+    cout << "Exported " << students_table.row_count << " student(s), " << grades_table.row_count << " grade(s), "
+         << conduct_table.row_count << " conduct note(s) and " << tuition_table.row_count << " tuition record(s) to "
+         << export_folder << endl;
+}
+
+// --- Replication (change log shipping to a read-only replica) ---
+
+mutex replica_mutex; // Guards the replica state between the tailing thread and the report menu
+
+long long nowMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static string sanitizeChangeField(string value) {
+    replace_if(value.begin(), value.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return value;
+}
+
+// Takes the exclusive lock on the change log that every session shares. Writers hold it from a data file
+// write until that change is logged, and --primary holds it while it snapshots, so the offset a snapshot
+// records splits the changes exactly. The OS drops the lock if the process dies. Nests within a process.
+void lockChangeLog() {
+    if (change_log_lock_depth++ > 0) return;
+#ifdef _WIN32
+    change_log_lock_handle = CreateFileA(change_log_file.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                         OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (change_log_lock_handle != INVALID_HANDLE_VALUE) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = 0xFFFFFFFF; // Lock a byte far past the data, so our own streams can still read and append
+        overlapped.OffsetHigh = 0x7FFFFFFF;
+        if (LockFileEx(change_log_lock_handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)) return;
+        CloseHandle(change_log_lock_handle);
+        change_log_lock_handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    change_log_lock_fd = open(change_log_file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (change_log_lock_fd >= 0) {
+        int rc;
+        while ((rc = flock(change_log_lock_fd, LOCK_EX)) != 0 && errno == EINTR) {}
+        if (rc == 0) return;
+        close(change_log_lock_fd);
+        change_log_lock_fd = -1;
+    }
+#endif
+    cout << "Warning: Failed to lock " << change_log_file << ", changes may reach the replica out of order." << endl;
+}
+
+void unlockChangeLog() {
+    if (change_log_lock_depth == 0 || --change_log_lock_depth > 0) return;
+#ifdef _WIN32
+    if (change_log_lock_handle == INVALID_HANDLE_VALUE) return;
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = 0xFFFFFFFF;
+    overlapped.OffsetHigh = 0x7FFFFFFF;
+    UnlockFileEx(change_log_lock_handle, 0, 1, 0, &overlapped);
+    CloseHandle(change_log_lock_handle);
+    change_log_lock_handle = INVALID_HANDLE_VALUE;
+#else
+    if (change_log_lock_fd < 0) return;
+    flock(change_log_lock_fd, LOCK_UN);
+    close(change_log_lock_fd);
+    change_log_lock_fd = -1;
+#endif
+}
+
+ChangeLogLock_t::ChangeLogLock_t() { lockChangeLog(); }
+ChangeLogLock_t::~ChangeLogLock_t() { unlockChangeLog(); }
+
+// Sequence number of the last change in the log, read backwards from the end. Call with the lock held.
+long long readLastChangeSeq(bool& out_ends_with_newline) {
+    out_ends_with_newline = true;
+    ifstream ifs_change_log(change_log_file, ios::binary);
+    if (!ifs_change_log.is_open()) return 0;
+    ifs_change_log.seekg(0, ios::end);
+    streamoff log_size = ifs_change_log.tellg();
+    if (log_size <= 0) return 0;
+    for (streamoff window = 4096; ; window *= 2) {
+        streamoff start = max<streamoff>(0, log_size - window);
+        string tail(static_cast<size_t>(log_size - start), '\0');
+        ifs_change_log.seekg(start);
+        ifs_change_log.read(&tail[0], static_cast<streamsize>(tail.size()));
+        out_ends_with_newline = tail.back() == '\n';
+        // Only whole lines count: the window may cut the first one and a crashed session the last one
+        size_t line_end = out_ends_with_newline ? tail.size() - 1 : tail.rfind('\n');
+        while (line_end != string::npos) {
+            size_t line_start = line_end == 0 ? string::npos : tail.rfind('\n', line_end - 1);
+            if (line_start == string::npos && start > 0) break;
+            line_start = line_start == string::npos ? 0 : line_start + 1;
+            size_t tab_pos = tail.find('\t', line_start);
+            if (tab_pos != string::npos && tab_pos < line_end && tab_pos > line_start && tab_pos - line_start <= 18 &&
+                all_of(tail.begin() + line_start, tail.begin() + tab_pos, [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; })) {
+                return stoll(tail.substr(line_start, tab_pos - line_start));
+            }
+            line_end = line_start == 0 ? string::npos : line_start - 1;
+        }
+        if (start == 0) return 0;
+    }
+}
+
+// Change log line format: <seq>\t<time ms>\t<OP>\t<field>...
+// ADMIT nisn name place_of_birth date_of_birth gender grade | GRADE nisn name subject grade
+// PAY nisn name paid unpaid | CONDUCT nisn name log_line
+// Every session logs once a replica snapshot exists; seq numbers come from the log itself under the lock.
+void recordChanges(const string& op, const vector<vector<string>>& rows) {
+    if (rows.empty()) return;
+    ChangeLogLock_t change_log_lock;
+    error_code ec;
+    if (!filesystem::exists(replica_snapshot_folder + "SNAPSHOT", ec)) return;
+    bool ends_with_newline;
+    long long seq = readLastChangeSeq(ends_with_newline);
+    stringstream batch;
+    if (!ends_with_newline) batch << "\n"; // Close a line torn by a crashed session; the replica skips it as malformed
+    long long now_ms = nowMillis();
+    for (const vector<string>& fields : rows) {
+        batch << ++seq << "\t" << now_ms << "\t" << op;
+        for (const string& field : fields) batch << "\t" << sanitizeChangeField(field);
+        batch << "\n";
+    }
+    ofstream ofs_change_log(change_log_file, ios::app | ios::binary);
+    if (!ofs_change_log.is_open()) { cout << "Error: Failed to open " << change_log_file << " for writing!" << endl; return; }
+    ofs_change_log << batch.str();
+    ofs_change_log.close();
+}
+
+void recordChange(const string& op, const vector<string>& fields) {
+    recordChanges(op, {fields});
+}
+
+// Copies one data file or folder into the snapshot; a source that doesn't exist yet is simply an empty dataset
+bool copySnapshotEntry(const string& source, const string& dest_folder) {
+    error_code ec;
+    if (!filesystem::exists(source, ec)) return true;
+    filesystem::copy(source, dest_folder + source, filesystem::copy_options::recursive, ec);
+    if (ec) { cout << "Error: Failed to copy " << source << " into the snapshot: " << ec.message() << endl; return false; }
+    return true;
+}
+
+// Snapshots the data folder so a replica can bootstrap; from then on every session logs its changes.
+// The change log lock is held throughout, so no session writes data or logs while the copy is taken.
+bool startPrimaryReplication() {
+    ChangeLogLock_t change_log_lock;
+    bool ends_with_newline;
+    long long last_seq = readLastChangeSeq(ends_with_newline);
+    error_code ec;
+    uintmax_t log_size = filesystem::file_size(change_log_file, ec);
+    if (ec) log_size = 0;
+
+    // Build the snapshot next to the old one and swap it in only once it is complete,
+    // so a failed copy never leaves a SNAPSHOT marker over partial data
+    string snapshot_dir = filesystem::path(replica_snapshot_folder).parent_path().string();
+    string staging_folder = snapshot_dir + ".tmp/";
+    filesystem::remove_all(staging_folder, ec);
+    filesystem::create_directories(staging_folder, ec);
+    if (ec) { cout << "Error: Failed to create " << staging_folder << "!" << endl; return false; }
+    if (!copySnapshotEntry(main_student_data_file, staging_folder) ||
+        !copySnapshotEntry(tuition_file, staging_folder) ||
+        !copySnapshotEntry(student_details_folder, staging_folder)) {
+        filesystem::remove_all(staging_folder, ec);
+        return false;
+    }
+
+    ofstream ofs_marker(staging_folder + "SNAPSHOT");
+    if (ofs_marker.is_open()) {
+        ofs_marker << "seq " << last_seq << endl;
+        ofs_marker << "offset " << log_size << endl;
+        ofs_marker << "time_ms " << nowMillis() << endl;
+        ofs_marker.close();
+    }
+    if (!ofs_marker) {
+        cout << "Error: Failed to write the snapshot marker!" << endl;
+        filesystem::remove_all(staging_folder, ec);
+        return false;
+    }
+
+    // Move the old snapshot aside rather than deleting it first, so the folder is only missing between two
+    // renames; a replica reading across the swap notices the marker changed and reads again (see runReplica())
+    string retired_dir = snapshot_dir + ".old";
+    filesystem::remove_all(retired_dir, ec);
+    bool had_snapshot = filesystem::exists(snapshot_dir, ec);
+    if (had_snapshot) {
+        filesystem::rename(snapshot_dir, retired_dir, ec);
+        if (ec) {
+            cout << "Error: Failed to move the old snapshot aside: " << ec.message() << endl;
+            filesystem::remove_all(staging_folder, ec);
+            return false;
+        }
+    }
+    filesystem::rename(staging_folder, snapshot_dir, ec);
+    if (ec) {
+        cout << "Error: Failed to move the snapshot into " << replica_snapshot_folder << ": " << ec.message() << endl;
+        error_code restore_ec;
+        if (had_snapshot) filesystem::rename(retired_dir, snapshot_dir, restore_ec);
+        filesystem::remove_all(staging_folder, restore_ec);
+        return false;
+    }
+    filesystem::remove_all(retired_dir, ec);
+    cout << "Snapshot written to " << replica_snapshot_folder << " at change #" << last_seq
+         << "; every session now logs its changes to " << change_log_file << endl;
+    return true;
+}
+
+// Whole SNAPSHOT marker text, empty when there is none; time_ms makes it differ between snapshots
+string readSnapshotMarker(const string& snapshot_folder) {
+    ifstream ifs_marker(snapshot_folder + "SNAPSHOT");
+    if (!ifs_marker.is_open()) return "";
+    stringstream marker_text;
+    marker_text << ifs_marker.rdbuf();
+    return marker_text.str();
+}
+
+bool loadReplicaSnapshot(ReplicaState_t& state, const string& snapshot_folder) {
+    ifstream ifs_marker(snapshot_folder + "SNAPSHOT");
+    if (!ifs_marker.is_open()) return false;
+    string key;
+    long long value;
+    while (ifs_marker >> key >> value) {
+        if (key == "seq") state.applied_seq = value;
+        else if (key == "offset") state.log_offset = static_cast<streamoff>(value);
+        else if (key == "time_ms") state.applied_primary_ms = value;
+    }
+    ifs_marker.close();
+    state.applied_local_ms = state.applied_primary_ms;
+
+    ifstream ifs_roster(snapshot_folder + main_student_data_file);
+    string ni, n;
+    int nisn_int;
+    while (getline(ifs_roster, ni) && getline(ifs_roster, n)) {
+        trimCarriageReturn(ni); trimCarriageReturn(n);
+        if (!isValidNisn(ni, nisn_int)) continue;
+        student s_detail;
+        s_detail.NISN = nisn_int;
+        s_detail.name = n;
+        s_detail.grade = 0.0f;
+        ifstream ifs_detail(snapshot_folder + student_details_folder + ni + "_" + n + ".txt");
+        if (ifs_detail.is_open()) parseStudentDetail(ifs_detail, s_detail);
+        state.students[nisn_int] = s_detail;
+    }
+
+    ifstream ifs_tuition(snapshot_folder + tuition_file);
+    int file_id;
+    string line_content;
+    while (ifs_tuition >> file_id >> ws && getline(ifs_tuition, line_content)) {
+        TuitionRecord_t record;
+        if (parseTuitionLine(file_id, line_content, record)) state.latest_tuition[file_id] = record;
+    }
+    return true;
+}
+
+bool applyChangeLine(ReplicaState_t& state, const string& line) {
+    vector<string> fields;
+    size_t start = 0, tab_pos;
+    while ((tab_pos = line.find('\t', start)) != string::npos) {
+        fields.push_back(line.substr(start, tab_pos - start));
+        start = tab_pos + 1;
+    }
+    fields.push_back(line.substr(start));
+    if (fields.size() < 5) return false;
+
+    int nisn_int;
+    if (!isValidNisn(fields[3], nisn_int)) return false;
+    const string& op = fields[2];
+    try {
+        if (op == "ADMIT" && fields.size() >= 9) {
+            student& s_detail = state.students[nisn_int];
+            s_detail.NISN = nisn_int;
+            s_detail.name = fields[4];
+            s_detail.placeofbirth = fields[5];
+            s_detail.dateofbirth = fields[6];
+            s_detail.gender = fields[7];
+            s_detail.grade = stof(fields[8]);
+        } else if (op == "GRADE" && fields.size() >= 7) {
+            state.students[nisn_int].subject_grades.push_back({fields[5], stoi(fields[6])});
+        } else if (op == "PAY" && fields.size() >= 7) {
+            state.latest_tuition[nisn_int] = {nisn_int, fields[4], stoi(fields[5]), stoi(fields[6])};
+        } else if (op == "CONDUCT" && fields.size() >= 6) {
+            state.students[nisn_int].conduct_log.push_back(fields[5]);
+        } else {
+            return false;
+        }
+        state.applied_seq = stoll(fields[0]);
+        state.applied_primary_ms = stoll(fields[1]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    state.applied_local_ms = nowMillis();
+    return true;
+}
+
+// Applies every complete line appended to the change log since the last poll
+void pollChangeLog(ReplicaState_t& state) {
+    lock_guard<mutex> lock(replica_mutex);
+    state.last_poll_ms = nowMillis();
+    ifstream ifs_change_log(change_log_file, ios::binary);
+    if (!ifs_change_log.is_open()) return;
+    ifs_change_log.seekg(0, ios::end);
+    streamoff log_size = ifs_change_log.tellg();
+    if (log_size <= state.log_offset) { state.pending_bytes = 0; return; }
+
+    ifs_change_log.seekg(state.log_offset);
+    string pending(static_cast<size_t>(log_size - state.log_offset), '\0');
+    ifs_change_log.read(&pending[0], static_cast<streamsize>(pending.size()));
+    pending.resize(static_cast<size_t>(ifs_change_log.gcount()));
+    ifs_change_log.close();
+
+    size_t line_start = 0, newline_pos;
+    while ((newline_pos = pending.find('\n', line_start)) != string::npos) { // A partly written last line waits for the next poll
+        string line = pending.substr(line_start, newline_pos - line_start);
+        trimCarriageReturn(line);
+        if (!line.empty() && !applyChangeLine(state, line)) cerr << "Warning: Skipped malformed change: " << line << endl;
+        line_start = newline_pos + 1;
+    }
+    state.log_offset += static_cast<streamoff>(line_start);
+    state.pending_bytes = log_size - state.log_offset;
+}
+
+void replicaShowGrades(ReplicaState_t& state) {
+    string nisn_str;
+    int nisn_int;
+    cout << "\n--- Student Grades and Average (Replica) ---" << endl;
+    cout << "Enter student NISN: ";
+    while (getline(cin, nisn_str) && !isValidNisn(nisn_str, nisn_int)) cout << "Invalid NISN. Please enter a numeric NISN: ";
+
+    lock_guard<mutex> lock(replica_mutex);
+    auto it = state.students.find(nisn_int);
+    if (it == state.students.end()) { cout << "Student with NISN " << nisn_int << " not found on the replica." << endl; return; }
+    const student& s_detail = it->second;
+    cout << "Grades for " << s_detail.name << ":" << endl;
+    double sum_of_grades = 0.0;
+    for (const auto& sg : s_detail.subject_grades) {
+        cout << "- " << sg.first << ": " << sg.second << endl;
+        sum_of_grades += sg.second;
+    }
+    if (s_detail.subject_grades.empty()) { cout << "No grades found for " << s_detail.name << "." << endl; return; }
+    cout << fixed << setprecision(2);
+    cout << "\nAverage grade for " << s_detail.name << ": " << sum_of_grades / s_detail.subject_grades.size() << endl;
+}
+
+void replicaGradeReport(ReplicaState_t& state) {
+    lock_guard<mutex> lock(replica_mutex);
+    cout << "\n--- Grade Averages for All Students (Replica) ---" << endl;
+    cout << left << setw(12) << "NISN" << setw(20) << "Name" << setw(10) << "Subjects" << "Average" << endl;
+    cout << fixed << setprecision(2);
+    for (const auto& entry : state.students) {
+        const student& s_detail = entry.second;
+        cout << left << setw(12) << entry.first << setw(20) << s_detail.name << setw(10) << s_detail.subject_grades.size();
+        if (s_detail.subject_grades.empty()) { cout << "-" << endl; continue; }
+        double sum_of_grades = 0.0;
+        for (const auto& sg : s_detail.subject_grades) sum_of_grades += sg.second;
+        cout << sum_of_grades / s_detail.subject_grades.size() << endl;
+    }
+    cout << right;
+}
+
+void replicaSearchTuition(ReplicaState_t& state) {
+    string search_id_str;
+    int search_id_int;
+    cout << "\n--- Search Tuition Status (Replica) ---" << endl;
+    cout << "Enter student NISN to search: ";
+    while (getline(cin, search_id_str) && !isValidNisn(search_id_str, search_id_int)) cout << "Invalid NISN. Please enter a numeric NISN: ";
+
+    lock_guard<mutex> lock(replica_mutex);
+    auto it = state.latest_tuition.find(search_id_int);
+    if (it == state.latest_tuition.end()) { cout << "Student with NISN " << search_id_int << " not found in tuition records." << endl; return; }
+    const TuitionRecord_t& r = it->second;
+    cout << "\n--- Student Tuition Status (Latest Record) ---" << endl;
+    cout << "NISN: " << r.id << endl;
+    cout << "Name: " << (r.name.empty() ? "[No Name Recorded]" : r.name) << endl;
+    cout << "Last Amount Paid (in that transaction): " << r.paid_this_transaction << endl;
+    cout << "Current Outstanding Balance: " << r.unpaid_balance << endl;
+    cout << "Status: " << (r.unpaid_balance == 0 ? "Tuition fully paid." : "Payment still outstanding.") << endl;
+}
+
+void replicaShowStatus(ReplicaState_t& state) {
+    lock_guard<mutex> lock(replica_mutex);
+    long long now_ms = nowMillis();
+    cout << "\n--- Replication Status ---" << endl;
+    cout << "Last applied change: #" << state.applied_seq << " (log offset " << state.log_offset << ")" << endl;
+    cout << "Unapplied log bytes: " << state.pending_bytes << endl;
+    cout << "Apply delay of last change: " << max(0LL, state.applied_local_ms - state.applied_primary_ms) << " ms" << endl;
+    cout << "Age of last applied change: " << max(0LL, now_ms - state.applied_primary_ms) << " ms" << endl;
+    cout << "Last poll of " << change_log_file << ": " << max(0LL, now_ms - state.last_poll_ms) << " ms ago" << endl;
+}
+
+// Read-only reporting process: bootstraps from the snapshot, catches up on the log, then tails it
+int runReplica(const string& snapshot_folder_param) {
+    string snapshot_folder = snapshot_folder_param;
+    if (snapshot_folder.back() != '/' && snapshot_folder.back() != '\\') snapshot_folder += "/";
+    ReplicaState_t state;
+    // --primary may swap in a new snapshot while this one is read; only keep a read that saw one marker throughout
+    bool snapshot_loaded = false;
+    for (int attempt = 0; attempt < 5 && !snapshot_loaded; attempt++) {
+        if (attempt > 0) this_thread::sleep_for(chrono::milliseconds(100));
+        string marker_before = readSnapshotMarker(snapshot_folder);
+        state = ReplicaState_t();
+        snapshot_loaded = !marker_before.empty() && loadReplicaSnapshot(state, snapshot_folder) &&
+                          readSnapshotMarker(snapshot_folder) == marker_before;
+    }
+    if (!snapshot_loaded) {
+        cout << "Error: No snapshot in " << snapshot_folder << ". Start the primary with --primary first." << endl;
+        return 1;
+    }
+    long long snapshot_seq = state.applied_seq;
+    pollChangeLog(state); // Catch-up
+    cout << "Replica bootstrapped from " << snapshot_folder << ": " << state.students.size() << " student(s), caught up "
+         << state.applied_seq - snapshot_seq << " change(s) to #" << state.applied_seq << endl;
+
+    atomic<bool> tailing(true);
+    thread tail_thread([&state, &tailing]() {
+        while (tailing) {
+            this_thread::sleep_for(chrono::milliseconds(REPLICA_POLL_INTERVAL_MS));
+            pollChangeLog(state);
+        }
+    });
+
+    int choice;
+    do {
+        cout << "\n+==============================+" << endl;
+        cout << "|   Reporting Replica (Read)   |" << endl;
+        cout << "+==============================+" << endl;
+        cout << "1. Show Student's Grades and Average" << endl;
+        cout << "2. Grade Averages for All Students" << endl;
+        cout << "3. Search Student's Tuition Status" << endl;
+        cout << "4. Replication Status" << endl;
+        cout << "5. Exit" << endl;
+        cout << "Choose: ";
+        while (!(cin >> choice)) {
+            if (cin.eof()) { choice = 5; break; }
+            cout << "Invalid input. Please enter a number: "; cin.clear(); clearInputBuffer();
+        }
+        clearInputBuffer();
+        switch (choice) {
+            case 1: replicaShowGrades(state); break;
+            case 2: replicaGradeReport(state); break;
+            case 3: replicaSearchTuition(state); break;
+            case 4: replicaShowStatus(state); break;
+            case 5: cout << "Exiting replica. Goodbye!" << endl; break;
             default: cout << "Invalid choice. Please try again!" << endl;
-        } if(choice != 3) { cout << "Press Enter to continue..."; cin.get(); }
-    } while (choice != 3);
+        }
+    } while (choice != 5);
+
+    tailing = false;
+    tail_thread.join();
+    return 0;
 }
 
-int main() {
+// Usage: sekolah [--primary | --replica [snapshot_folder]]
+// --primary publishes a fresh replica snapshot before serving; any number of sessions may run with or without it
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--replica") return runReplica(argc > 2 ? argv[2] : replica_snapshot_folder);
+    if (mode == "--primary" && !startPrimaryReplication()) return 1;
+
+    warmStudentCache();
+
     int choice;
     do {
         // system("cls"); // Non-portable
@@ -790,7 +2473,8 @@ int main() {
         cout << "4. Show Student's Grades and Average" << endl;
         cout << "5. Tuition Fee Services" << endl;
         cout << "6. Manage Student Conduct Log" << endl;
-        cout << "7. Exit " << endl;
+        cout << "7. Export Data for Analytics" << endl;
+        cout << "8. Exit " << endl;
         cout << "Choose: ";
 
         while (!(cin >> choice)) {
@@ -805,12 +2489,13 @@ int main() {
             case 4: inputGradesLoader(2); break;
             case 5: menuTuition(); break;
             case 6: menuConductLog(); break;
-            case 7: cout << "Exiting program. Goodbye!" << endl; break;
+            case 7: exportSchoolData(); break;
+            case 8: cout << "Exiting program. Goodbye!" << endl; break;
             default: cout << "Invalid choice. Please try again!" << endl;
         }
-        if (choice != 7 && choice != 5 && choice != 6) { 
+        if (choice != 8 && choice != 5 && choice != 6) { 
              cout << "Press Enter to continue..."; cin.get();
         }
-    } while (choice != 7); 
+    } while (choice != 8); 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,405 @@
+// Load-test driver for sekolah: runs N simulated front-desk sessions of the interactive
+// program at once against a temporary copy of the data files, then checks the files.
+//
+// Usage: sekolah_loadtest <path-to-sekolah> [sessions=4] [ops_per_session=20] [data_dir=.]
+//
+// POSIX only (fork/pipe/poll). Build: g++ -std=c++17 -pthread -o sekolah_loadtest sekolah_loadtest.cpp
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <filesystem>
+#include <cmath>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+const int BASE_TUITION = 15000000; // Must match sekolah.cpp
+const int EXPECT_TIMEOUT_MS = 10000;
+
+// Struct for one running copy of the program
+struct Session_t {
+    int id;
+    pid_t pid = -1;
+    int to_child = -1;   // Child's stdin
+    int from_child = -1; // Child's stdout
+    string buffer;       // Output read but not yet matched
+    string error;        // Set when the session stopped early
+};
+
+// Struct for one timed operation
+struct OpSample_t {
+    string op;
+    double latency_ms;
+};
+
+// Struct for a roster entry of the test dataset
+struct RosterEntry_t {
+    string nisn;
+    string name;
+};
+
+// Struct for what the sessions did, checked against the files afterwards
+struct ExpectedWrites_t {
+    map<string, int> grade_lines;  // "Subject: LT..." text -> times it was written
+    map<string, int> conduct_notes; // "Note: LT..." text -> times it was written
+    int payments_saved = 0;
+};
+
+string sekolah_path;
+string work_dir;
+vector<RosterEntry_t> roster;
+mutex results_mutex;
+mutex spawn_mutex; // Held from pipe() to fork() so no other session inherits these pipe ends
+vector<OpSample_t> samples;
+ExpectedWrites_t expected;
+
+// --- Function Declarations ---
+void trimCarriageReturn(string& line);
+bool startSession(Session_t& s);
+void stopSession(Session_t& s);
+bool sendLine(Session_t& s, const string& text);
+int expectAny(Session_t& s, const vector<string>& patterns);
+bool opPayTuition(Session_t& s, mt19937& rng, int op_no);
+bool opInputGrade(Session_t& s, mt19937& rng, int op_no);
+bool opConductNote(Session_t& s, mt19937& rng, int op_no);
+void runSession(int session_id, int ops_per_session);
+double percentile(vector<double> values, double p);
+int checkLedger(size_t baseline_lines);
+int checkDetailFiles();
+
+// --- Function Implementations ---
+
+void trimCarriageReturn(string& line) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+}
+
+bool startSession(Session_t& s) {
+    int in_pipe[2], out_pipe[2];
+    unique_lock<mutex> spawn_lock(spawn_mutex);
+    if (pipe(in_pipe) != 0) { s.error = "pipe() failed"; return false; }
+    if (pipe(out_pipe) != 0) { close(in_pipe[0]); close(in_pipe[1]); s.error = "pipe() failed"; return false; }
+    // FD_CLOEXEC so sessions forked later from other driver threads don't inherit these ends;
+    // dup2() clears the flag on the child's stdin/stdout
+    for (int fd : {in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1]}) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    s.pid = fork();
+    if (s.pid < 0) {
+        close(in_pipe[0]); close(in_pipe[1]); close(out_pipe[0]); close(out_pipe[1]);
+        s.error = "fork() failed"; return false;
+    }
+    if (s.pid == 0) {
+        dup2(in_pipe[0], STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        close(in_pipe[0]); close(in_pipe[1]); close(out_pipe[0]); close(out_pipe[1]);
+        if (chdir(work_dir.c_str()) != 0) _exit(126);
+        signal(SIGPIPE, SIG_DFL); // The driver ignores SIGPIPE, don't pass that on to sekolah
+        execl(sekolah_path.c_str(), sekolah_path.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    spawn_lock.unlock();
+    close(in_pipe[0]); close(out_pipe[1]);
+    s.to_child = in_pipe[1];
+    s.from_child = out_pipe[0];
+    return expectAny(s, {"Choose: "}) == 0;
+}
+
+void stopSession(Session_t& s) {
+    if (s.pid <= 0) return;
+    if (s.error.empty() && sendLine(s, "8")) expectAny(s, {"Goodbye!"});
+    close(s.to_child); close(s.from_child);
+    // A session that timed out or desynced may be stuck waiting on input it will never get
+    if (!s.error.empty()) kill(s.pid, SIGTERM);
+    int status;
+    waitpid(s.pid, &status, 0);
+    s.pid = -1;
+}
+
+bool sendLine(Session_t& s, const string& text) {
+    string line = text + "\n";
+    size_t written = 0;
+    while (written < line.size()) {
+        ssize_t n = write(s.to_child, line.data() + written, line.size() - written);
+        if (n <= 0) { s.error = "write to session failed"; return false; }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads until one of the prompts appears; returns its index, or -1 on timeout/EOF
+int expectAny(Session_t& s, const vector<string>& patterns) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(EXPECT_TIMEOUT_MS);
+    while (true) {
+        size_t best_pos = string::npos;
+        int best_idx = -1;
+        for (size_t i = 0; i < patterns.size(); i++) {
+            size_t pos = s.buffer.find(patterns[i]);
+            if (pos != string::npos && pos < best_pos) { best_pos = pos; best_idx = static_cast<int>(i); }
+        }
+        if (best_idx >= 0) {
+            s.buffer.erase(0, best_pos + patterns[best_idx].size());
+            return best_idx;
+        }
+        int remaining_ms = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count());
+        if (remaining_ms <= 0) { s.error = "timeout waiting for \"" + patterns[0] + "\""; return -1; }
+        pollfd pfd = {s.from_child, POLLIN, 0};
+        if (poll(&pfd, 1, remaining_ms) <= 0) continue;
+        char chunk[4096];
+        ssize_t n = read(s.from_child, chunk, sizeof(chunk));
+        if (n <= 0) { s.error = "session exited while waiting for \"" + patterns[0] + "\""; return -1; }
+        s.buffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+static void recordSample(const string& op, chrono::steady_clock::time_point start) {
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    lock_guard<mutex> lock(results_mutex);
+    samples.push_back({op, ms});
+}
+
+// Main menu -> Tuition -> Pay Tuition -> back to main menu
+bool opPayTuition(Session_t& s, mt19937& rng, int /*op_no*/) {
+    const RosterEntry_t& target = roster[rng() % roster.size()];
+    int amount = 1000 + static_cast<int>(rng() % 50000);
+    auto start = chrono::steady_clock::now();
+    if (!sendLine(s, "5") || expectAny(s, {"Choose a service: "}) < 0) return false;
+    if (!sendLine(s, "1") || expectAny(s, {"NISN: "}) < 0) return false;
+    if (!sendLine(s, target.nisn)) return false;
+    int prompt = expectAny(s, {"amount you wish to pay: ", "full name: ", "Press Enter to continue..."});
+    if (prompt < 0) return false;
+    if (prompt == 1) {
+        if (!sendLine(s, target.name) || expectAny(s, {"amount you wish to pay: "}) < 0) return false;
+        prompt = 0;
+    }
+    bool saved = false;
+    if (prompt == 0) {
+        if (!sendLine(s, to_string(amount))) return false;
+        int outcome = expectAny(s, {"Tuition payment record saved.", "Error: "});
+        if (outcome < 0) return false;
+        saved = (outcome == 0);
+        if (expectAny(s, {"Press Enter to continue..."}) < 0) return false;
+    }
+    recordSample("pay_tuition", start);
+    {
+        lock_guard<mutex> lock(results_mutex);
+        if (saved) expected.payments_saved++;
+    }
+    if (!sendLine(s, "") || expectAny(s, {"Choose a service: "}) < 0) return false;
+    return sendLine(s, "4") && expectAny(s, {"Choose: "}) >= 0;
+}
+
+// Main menu -> Input Subject Grades -> one subject for one student
+bool opInputGrade(Session_t& s, mt19937& rng, int op_no) {
+    size_t student_no = 1 + rng() % roster.size();
+    string subject = "LT" + to_string(s.id) + "_" + to_string(op_no);
+    int grade = static_cast<int>(rng() % 101);
+    auto start = chrono::steady_clock::now();
+    if (!sendLine(s, "3") || expectAny(s, {"(or 0 to go back): "}) < 0) return false;
+    if (!sendLine(s, to_string(student_no))) return false;
+    int prompt = expectAny(s, {"Subject name: ", "Press Enter to continue..."});
+    if (prompt < 0) return false;
+    if (prompt == 0) {
+        if (!sendLine(s, subject) || expectAny(s, {"Grade for " + subject + ": "}) < 0) return false;
+        if (!sendLine(s, to_string(grade)) || expectAny(s, {"THIS student? (y/n): "}) < 0) return false;
+        if (!sendLine(s, "n") || expectAny(s, {"ANOTHER student? (y/n): "}) < 0) return false;
+        if (!sendLine(s, "n") || expectAny(s, {"Press Enter to continue..."}) < 0) return false;
+        lock_guard<mutex> lock(results_mutex);
+        expected.grade_lines[roster[student_no - 1].nisn + "|Subject: " + subject + ", Grade: " + to_string(grade)]++;
+    }
+    recordSample("input_grade", start);
+    return sendLine(s, "") && expectAny(s, {"Choose: "}) >= 0;
+}
+
+// Main menu -> Conduct Log -> Add Conduct Note -> back to main menu
+bool opConductNote(Session_t& s, mt19937& rng, int op_no) {
+    size_t student_no = 1 + rng() % roster.size();
+    string note = "LT" + to_string(s.id) + "_" + to_string(op_no);
+    string date = "2026-" + string(rng() % 2 ? "09" : "10") + "-" + to_string(10 + rng() % 18);
+    auto start = chrono::steady_clock::now();
+    if (!sendLine(s, "6") || expectAny(s, {"Choose: "}) < 0) return false;
+    if (!sendLine(s, "1") || expectAny(s, {"Enter student number: "}) < 0) return false;
+    if (!sendLine(s, to_string(student_no)) || expectAny(s, {"Enter date (YYYY-MM-DD): "}) < 0) return false;
+    if (!sendLine(s, date) || expectAny(s, {"Observation): "}) < 0) return false;
+    if (!sendLine(s, rng() % 3 ? "Observation" : "Warning") || expectAny(s, {"Enter note description: "}) < 0) return false;
+    if (!sendLine(s, note) || expectAny(s, {"Press Enter to continue..."}) < 0) return false;
+    recordSample("conduct_note", start);
+    {
+        lock_guard<mutex> lock(results_mutex);
+        expected.conduct_notes[roster[student_no - 1].nisn + "|Note: " + note]++;
+    }
+    if (!sendLine(s, "") || expectAny(s, {"Choose: "}) < 0) return false;
+    return sendLine(s, "6") && expectAny(s, {"Choose: "}) >= 0;
+}
+
+void runSession(int session_id, int ops_per_session) {
+    Session_t s;
+    s.id = session_id;
+    mt19937 rng(static_cast<unsigned int>(session_id) * 7919u + 17u);
+    auto start = chrono::steady_clock::now();
+    bool ok = startSession(s);
+    if (ok) recordSample("startup", start);
+    for (int op_no = 0; ok && op_no < ops_per_session; op_no++) {
+        switch (rng() % 3) {
+            case 0: ok = opPayTuition(s, rng, op_no); break;
+            case 1: ok = opInputGrade(s, rng, op_no); break;
+            default: ok = opConductNote(s, rng, op_no); break;
+        }
+    }
+    stopSession(s);
+    if (!s.error.empty()) {
+        lock_guard<mutex> lock(results_mutex);
+        cerr << "Session " << session_id << " stopped: " << s.error << endl;
+    }
+}
+
+double percentile(vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(ceil(p * values.size()));
+    return values[rank == 0 ? 0 : rank - 1];
+}
+
+// Every ledger line written during the run must follow from the previous balance of that NISN
+int checkLedger(size_t baseline_lines) {
+    ifstream ifs(work_dir + "/tuition.txt");
+    map<int, int> last_unpaid;
+    string line;
+    size_t line_no = 0;
+    int problems = 0, new_lines = 0;
+    while (getline(ifs, line)) {
+        line_no++;
+        trimCarriageReturn(line);
+        stringstream ss(line);
+        vector<string> tokens;
+        string token;
+        while (ss >> token) tokens.push_back(token);
+        if (tokens.size() < 3) continue;
+        int id, paid, unpaid;
+        try { id = stoi(tokens[0]); paid = stoi(tokens[tokens.size() - 2]); unpaid = stoi(tokens.back()); }
+        catch (const exception&) { if (line_no > baseline_lines) { cout << "  Malformed ledger line " << line_no << ": " << line << endl; problems++; } continue; }
+        if (line_no > baseline_lines) {
+            new_lines++;
+            int previous = last_unpaid.count(id) ? last_unpaid[id] : BASE_TUITION;
+            int expected_unpaid = max(0, previous - paid);
+            if (unpaid != expected_unpaid) {
+                cout << "  Ledger line " << line_no << " (NISN " << id << "): balance " << unpaid
+                     << ", expected " << expected_unpaid << " from previous " << previous << endl;
+                problems++;
+            }
+        }
+        last_unpaid[id] = unpaid;
+    }
+    if (new_lines != expected.payments_saved) {
+        cout << "  Ledger has " << new_lines << " new line(s), sessions saved " << expected.payments_saved << " payment(s)" << endl;
+        problems++;
+    }
+    return problems;
+}
+
+// Every scripted grade and conduct note must be in its student's detail file exactly once
+int checkDetailFiles() {
+    map<string, int> found;
+    for (const RosterEntry_t& r : roster) {
+        ifstream ifs(work_dir + "/class/" + r.nisn + "_" + r.name + ".txt");
+        string line;
+        while (getline(ifs, line)) {
+            trimCarriageReturn(line);
+            if (line.rfind("Subject: LT", 0) == 0) found[r.nisn + "|" + line]++;
+            size_t note_pos = line.find(", Note: LT");
+            if (line.rfind("Log: ", 0) == 0 && note_pos != string::npos) found[r.nisn + "|" + line.substr(note_pos + 2)]++;
+        }
+    }
+    int problems = 0;
+    auto compare = [&](const map<string, int>& wanted, const string& what) {
+        for (const auto& w : wanted) {
+            int have = found.count(w.first) ? found[w.first] : 0;
+            if (have != w.second) {
+                cout << "  " << what << " " << w.first << ": written " << w.second << "x, found " << have << "x" << endl;
+                problems++;
+            }
+        }
+    };
+    compare(expected.grade_lines, "Grade");
+    compare(expected.conduct_notes, "Conduct note");
+    return problems;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <path-to-sekolah> [sessions=4] [ops_per_session=20] [data_dir=.]" << endl;
+        return 2;
+    }
+    sekolah_path = filesystem::absolute(argv[1]).string();
+    int num_sessions = argc > 2 ? atoi(argv[2]) : 4;
+    int ops_per_session = argc > 3 ? atoi(argv[3]) : 20;
+    string data_dir = argc > 4 ? argv[4] : ".";
+    if (num_sessions <= 0 || ops_per_session < 0) { cout << "Invalid session or operation count." << endl; return 2; }
+    signal(SIGPIPE, SIG_IGN);
+
+    // Temporary dataset so the real files are never touched
+    char dir_template[] = "/tmp/sekolah_load_XXXXXX";
+    if (mkdtemp(dir_template) == nullptr) { cout << "Error: Failed to create temporary folder." << endl; return 2; }
+    work_dir = dir_template;
+    error_code ec;
+    filesystem::copy_file(data_dir + "/data_student.txt", work_dir + "/data_student.txt", ec);
+    if (ec) { cout << "Error: " << data_dir << "/data_student.txt not found." << endl; return 2; }
+    filesystem::copy_file(data_dir + "/tuition.txt", work_dir + "/tuition.txt", ec);
+    filesystem::copy(data_dir + "/class", work_dir + "/class", filesystem::copy_options::recursive, ec);
+
+    ifstream ifs_roster(work_dir + "/data_student.txt");
+    string ni, n;
+    while (getline(ifs_roster, ni) && getline(ifs_roster, n)) {
+        trimCarriageReturn(ni); trimCarriageReturn(n);
+        roster.push_back({ni, n});
+    }
+    ifs_roster.close();
+    if (roster.empty()) { cout << "Error: The dataset has no admitted students to script against." << endl; return 2; }
+
+    size_t baseline_ledger_lines = 0;
+    {
+        ifstream ifs_tuition(work_dir + "/tuition.txt");
+        string line;
+        while (getline(ifs_tuition, line)) baseline_ledger_lines++;
+    }
+
+    cout << "Running " << num_sessions << " session(s) x " << ops_per_session << " operation(s) in " << work_dir << endl;
+    auto run_start = chrono::steady_clock::now();
+    vector<thread> drivers;
+    for (int i = 0; i < num_sessions; i++) drivers.emplace_back(runSession, i + 1, ops_per_session);
+    for (thread& d : drivers) d.join();
+    double run_seconds = chrono::duration<double>(chrono::steady_clock::now() - run_start).count();
+
+    map<string, vector<double>> latencies;
+    for (const OpSample_t& sample : samples) latencies[sample.op].push_back(sample.latency_ms);
+    cout << "\n" << left << setw(14) << "Operation" << right << setw(8) << "Count" << setw(12) << "Ops/s"
+         << setw(12) << "p50 (ms)" << setw(12) << "p99 (ms)" << endl;
+    cout << fixed << setprecision(2);
+    for (const auto& l : latencies) {
+        cout << left << setw(14) << l.first << right << setw(8) << l.second.size()
+             << setw(12) << l.second.size() / run_seconds
+             << setw(12) << percentile(l.second, 0.50) << setw(12) << percentile(l.second, 0.99) << endl;
+    }
+    cout << "Wall time: " << run_seconds << " s" << endl;
+
+    cout << "\nConsistency check:" << endl;
+    int problems = checkLedger(baseline_ledger_lines) + checkDetailFiles();
+    if (problems == 0) {
+        cout << "  Ledger and detail files are consistent." << endl;
+        filesystem::remove_all(work_dir, ec);
+        return 0;
+    }
+    cout << "  " << problems << " problem(s) found. Dataset kept in " << work_dir << endl;
+    return 1;
+}